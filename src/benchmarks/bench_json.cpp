@@ -0,0 +1,46 @@
+#include <entt/entity/registry.hpp>
+
+#include "benchmark.hpp"
+
+#include "json_manager.hpp"
+#include "message_handler.hpp"
+
+void benchJson(BenchmarkSuite& _Suite)
+{
+    entt::registry Reg;
+    Reg.set<MessageHandler>();
+    Reg.ctx<MessageHandler>().setLevel(MessageHandler::ERROR);
+
+    JsonManager Json(Reg);
+    const std::string Stamp{"2021:1234567.89"};
+
+    // Same content as dynamic data broadcast of a single object
+    _Suite.run("json/notification/dynamic_data",
+               [&]
+               {
+                   Json.createNotification("bc_dynamic_data")
+                       .addParam("eid", std::uint32_t(42))
+                       .addParam("ts", Stamp)
+                       .addParam("ts_r", std::uint64_t(1617000000000000))
+                       .addParam("name", "Earth")
+                       .addParam("m", 5.972e24)
+                       .addParam("i", 8.008e37)
+                       .addParam("r", 6378137.0)
+                       .addParam("spx", 0.0)
+                       .addParam("spy", 6.0e21)
+                       .addParam("px", 0.0)
+                       .addParam("py", -152.1e9)
+                       .finalise();
+                   auto s = Json.getString();
+                   doNotOptimise(s);
+               });
+
+    _Suite.run("json/result/success",
+               [&]
+               {
+                   Json.createResult(true)
+                       .finalise(1);
+                   auto s = Json.getString();
+                   doNotOptimise(s);
+               });
+}
@@ -0,0 +1,71 @@
+#include <fstream>
+#include <iostream>
+
+#include <argagg/argagg.hpp>
+
+#include "benchmark.hpp"
+
+int main(int argc, char* argv[])
+{
+    argagg::parser ArgParser
+        {{
+            {"filter", {"-f", "--filter"},
+             "Only run benchmarks containing the given string", 1},
+            {"help", {"-h", "--help"},
+             "Shows this help message", 0},
+            {"json", {"-j", "--json"},
+             "Write results to given JSON file", 1},
+            {"quick", {"-q", "--quick"},
+             "Fewer and shorter samples", 0}
+        }};
+
+    argagg::parser_results Args;
+    try
+    {
+        Args = ArgParser.parse(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Couldn't parse command line arguments, error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (Args["help"])
+    {
+        std::cout << "USAGE: \n\n" << ArgParser;
+        return EXIT_SUCCESS;
+    }
+
+    BenchmarkSuite Suite;
+    if (Args["filter"]) Suite.setFilter(Args["filter"].as<std::string>());
+    if (Args["quick"])
+    {
+        Suite.setMinSampleTime(0.01);
+        Suite.setSamples(3);
+    }
+
+    benchGravity(Suite);
+    benchIntegrator(Suite);
+    benchJson(Suite);
+    benchLocalWorlds(Suite);
+    benchName(Suite);
+    benchParse(Suite);
+    benchParticles(Suite);
+    benchGalaxy(Suite);
+
+    if (Args["json"])
+    {
+        std::ofstream File(Args["json"].as<std::string>());
+        if (!File)
+        {
+            std::cerr << "Couldn't open " << Args["json"].as<std::string>() << std::endl;
+            return EXIT_FAILURE;
+        }
+        Suite.writeJson(File);
+    }
+    else
+    {
+        Suite.writeText(std::cout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <concurrentqueue/concurrentqueue.h>
+#include <entt/entity/registry.hpp>
+#include <rapidjson/document.h>
+
+#include "benchmark.hpp"
+
+#include "json_document_pool.hpp"
+#include "message_handler.hpp"
+#include "network_command.hpp"
+#include "network_message.hpp"
+#include "network_message_broker.hpp"
+
+// Parsing throughput of incoming requests. 10k clients each send a mix of
+// commands and subscriptions, including a batch request. Compared are
+//  - the former approach (document allocated per message, parsing from a
+//    copied payload)
+//  - in-situ parsing into pooled documents
+//  - full broker processing (parse, validate, decode, route)
+
+namespace
+{
+    constexpr int NUMBER_OF_CLIENTS = 10000;
+
+    std::vector<NetworkMessage> createMessages(entt::registry& _RegClients)
+    {
+        static const std::vector<std::string> Templates
+        {
+            R"({"jsonrpc": "2.0", "method": "cmd_start_simulation", "id": 1})",
+            R"({"jsonrpc": "2.0", "method": "cmd_accelerate_simulation", "params": [10.0], "id": 2})",
+            R"({"jsonrpc": "2.0", "method": "sub_perf_stats_s1", "id": 3})",
+            R"({"jsonrpc": "2.0", "method": "uns_perf_stats_s1", "id": 4})",
+            R"({"jsonrpc": "2.0", "method": "cmd_stop_simulation", "id": 5})",
+            R"([{"jsonrpc": "2.0", "method": "sub_sim_stats_s5", "id": 6}, )"
+            R"({"jsonrpc": "2.0", "method": "uns_sim_stats_s5", "id": 7}])"
+        };
+
+        std::vector<NetworkMessage> Messages;
+        Messages.reserve(NUMBER_OF_CLIENTS*Templates.size());
+        for (auto i=0; i<NUMBER_OF_CLIENTS; ++i)
+        {
+            auto ClientID = _RegClients.create();
+            for (const auto& t : Templates) Messages.push_back({ClientID, t});
+        }
+        return Messages;
+    }
+}
+
+void benchParse(BenchmarkSuite& _Suite)
+{
+    entt::registry RegClients;
+    entt::registry Reg;
+
+    Reg.set<MessageHandler>();
+    Reg.ctx<MessageHandler>().setLevel(MessageHandler::ERROR);
+
+    const auto Messages = createMessages(RegClients);
+    const auto n = Messages.size();
+
+    // Payloads are copied in all cases (dequeueing), in-situ parsing
+    // modifies them
+    _Suite.run("parse/shared_document/10k_clients",
+               [&]
+               {
+                   for (const auto& m : Messages)
+                   {
+                       NetworkMessage Copy{m};
+                       auto Doc = std::make_shared<rapidjson::Document>();
+                       Doc->Parse(Copy.Payload.c_str());
+                       doNotOptimise(Doc);
+                   }
+               }, n);
+
+    JsonDocumentPool Pool;
+    _Suite.run("parse/pooled_insitu/10k_clients",
+               [&]
+               {
+                   for (const auto& m : Messages)
+                   {
+                       NetworkMessage Copy{m};
+                       auto Doc = Pool.acquire();
+                       Doc->ParseInsitu(&Copy.Payload[0]);
+                       doNotOptimise(*Doc);
+                   }
+               }, n);
+
+    moodycamel::ConcurrentQueue<NetworkCommand> QueueSim;
+    moodycamel::ConcurrentQueue<NetworkCommand> QueueNet;
+    moodycamel::ConcurrentQueue<NetworkMessage> QueueOut;
+    NetworkMessageBroker Broker(Reg, RegClients, &QueueSim, &QueueNet, &QueueOut);
+
+    NetworkCommand c;
+    NetworkMessage Out;
+    _Suite.run("broker/process/10k_clients",
+               [&]
+               {
+                   for (const auto& m : Messages)
+                   {
+                       NetworkMessage Copy{m};
+                       Broker.process(Copy);
+                   }
+                   while (QueueSim.try_dequeue(c)) {}
+                   while (QueueOut.try_dequeue(Out)) {}
+               }, n);
+}
@@ -0,0 +1,100 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+#include "benchmark.hpp"
+
+#include "command_buffer.hpp"
+#include "galactic_field.hpp"
+#include "galactic_rotation.hpp"
+#include "message_handler.hpp"
+#include "simulation_manager.hpp"
+
+void benchGalaxy(BenchmarkSuite& _Suite)
+{
+    std::unique_ptr<entt::registry> RegClients;
+    std::unique_ptr<entt::registry> Reg;
+    std::unique_ptr<SimulationManager> Simulation;
+
+    _Suite.runOnce("simulation/generate_galaxy",
+                   [&]
+                   {
+                       Simulation.reset();
+                       Reg = std::make_unique<entt::registry>();
+                       RegClients = std::make_unique<entt::registry>();
+                       Reg->set<MessageHandler>();
+                       Reg->ctx<MessageHandler>().setLevel(MessageHandler::ERROR);
+                       Simulation = std::make_unique<SimulationManager>(*Reg, *RegClients);
+                   },
+                   [&]
+                   {
+                       Simulation->generateGalaxy();
+                   });
+
+    // Copy at tick boundary, budget is 1ms
+    if (Simulation)
+    {
+        std::vector<char> Buffer;
+        _Suite.run("simulation/checkpoint_capture",
+                   [&]
+                   {
+                       Buffer.clear();
+                       Simulation->captureCheckpoint(Buffer);
+                       doNotOptimise(Buffer);
+                   });
+    }
+    Simulation.reset();
+
+    // Evaluated when serialising galaxy data, items are stars
+    constexpr std::size_t Stars = 1000000;
+    std::mt19937 Generator;
+    std::normal_distribution<double> DistPosition(0.0, 5.0e21);
+    std::vector<double> X0(Stars), Y0(Stars), X(Stars), Y(Stars);
+    for (auto i=0u; i<Stars; ++i)
+    {
+        X0[i] = DistPosition(Generator);
+        Y0[i] = DistPosition(Generator);
+    }
+    // Field of a galaxy of the generated size, built in the background
+    StarTable Table;
+    for (auto i=0u; i<16000; ++i)
+    {
+        Table.add(entt::entity(i), {X0[i], Y0[i]}, 2.0e30, 7.0e8, SpectralClassE::G, 5772.0);
+    }
+    // Field and rotation curve are built regardless of the filter, the
+    // lookups below need them
+    const auto Field = std::make_unique<const GalacticField>(Table);
+    const GalacticRotation Rotation(*Field, Table);
+
+    std::unique_ptr<GalacticField> Built;
+    _Suite.runOnce("galaxy/field/build",
+                   [&]{Built.reset();},
+                   [&]{Built = std::make_unique<GalacticField>(Table);});
+
+    // Derived once at startup
+    _Suite.runOnce("galaxy/rotation/curve",
+                   []{},
+                   [&]
+                   {
+                       GalacticRotation Derived(*Field, Table);
+                       doNotOptimise(Derived);
+                   });
+
+    _Suite.run("galaxy/rotation/"+std::to_string(Stars),
+               [&]
+               {
+                   Rotation.getPositions(Stars, X0.data(), Y0.data(), 3.0e15, X.data(), Y.data());
+                   doNotOptimise(X);
+               }, Stars);
+
+    // Items are lookups
+    Vec2Dd a{0.0, 0.0};
+    _Suite.run("galaxy/field/acceleration/"+std::to_string(Stars),
+               [&]
+               {
+                   for (auto i=0u; i<Stars; ++i) a += Field->getAcceleration({X0[i], Y0[i]});
+                   doNotOptimise(a);
+               }, Stars);
+}
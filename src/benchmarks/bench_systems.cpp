@@ -0,0 +1,213 @@
+#include <limits>
+#include <random>
+#include <string>
+
+#include <entt/entity/registry.hpp>
+
+#include "benchmark.hpp"
+
+#include "acceleration_component.hpp"
+#include "body_component.hpp"
+#include "gravity_system.hpp"
+#include "integrator_system.hpp"
+#include "job_pool.hpp"
+#include "kinematic_order_system.hpp"
+#include "local_world_manager.hpp"
+#include "name_system.hpp"
+#include "particle_population.hpp"
+#include "position_component.hpp"
+#include "sim_components.hpp"
+#include "velocity_component.hpp"
+
+namespace
+{
+    // Creates star systems with the given number of dynamic objects each,
+    // the first _Gravitators of each system are sources of gravity
+    void createSystems(entt::registry& _Reg, int _Systems, int _ObjectsPerSystem,
+                       int _Gravitators = std::numeric_limits<int>::max())
+    {
+        std::mt19937 Generator;
+        std::uniform_real_distribution<double> DistPosition(-1.0e11, 1.0e11);
+        std::uniform_real_distribution<double> DistMass(1.0e20, 1.0e30);
+
+        for (auto s=0; s<_Systems; ++s)
+        {
+            auto e_s = _Reg.create();
+            auto& System = _Reg.emplace<StarSystemComponent>(e_s);
+            for (auto o=0; o<_ObjectsPerSystem; ++o)
+            {
+                auto e = _Reg.create();
+                _Reg.emplace<AccelerationComponent>(e);
+                _Reg.emplace<VelocityComponent>(e);
+                _Reg.emplace<PositionComponent>(e, Vec2Dd{DistPosition(Generator), DistPosition(Generator)});
+                _Reg.emplace<BodyComponent>(e, DistMass(Generator), 1.0);
+                if (o < _Gravitators) _Reg.emplace<GravitatorComponent>(e);
+                System.Objects.push_back(e);
+            }
+        }
+    }
+
+    // Stack of boxes on ground, sleeping is disabled to keep it busy
+    void createLocalWorld(LocalWorldManager& _LocalWorlds, entt::entity _Parent, int _Bodies)
+    {
+        auto* World = _LocalWorlds.create(_Parent, {0.0f, -9.81f});
+        World->SetAllowSleeping(false);
+
+        b2BodyDef BodyDefGround;
+        b2PolygonShape ShapeGround;
+        ShapeGround.SetAsBox(50.0f, 0.5f);
+        World->CreateBody(&BodyDefGround)->CreateFixture(&ShapeGround, 0.0f);
+
+        b2PolygonShape ShapeBox;
+        ShapeBox.SetAsBox(0.5f, 0.5f);
+        for (auto i=0; i<_Bodies; ++i)
+        {
+            b2BodyDef BodyDefBox;
+            BodyDefBox.type = b2_dynamicBody;
+            BodyDefBox.position.Set(0.1f*(i%2), 1.0f+1.01f*i);
+            World->CreateBody(&BodyDefBox)->CreateFixture(&ShapeBox, 1.0f);
+        }
+    }
+}
+
+void benchGravity(BenchmarkSuite& _Suite)
+{
+    for (const auto& [Systems, Objects] : {std::pair{1, 3}, std::pair{1000, 3}, std::pair{1, 100}, std::pair{100, 30}})
+    {
+        entt::registry Reg;
+        createSystems(Reg, Systems, Objects);
+        GravitySystem SysGravity(Reg);
+
+        // Items are pairwise interactions
+        const auto Pairs = std::uint64_t(Systems) * Objects * (Objects-1) / 2;
+        _Suite.run("gravity/calculate_forces/"+std::to_string(Systems)+"x"+std::to_string(Objects),
+                   [&]{SysGravity.calculateForces();}, Pairs);
+
+        // Members of each system contiguous in the kinematic group
+        Reg.group<AccelerationComponent>(entt::get<VelocityComponent>);
+        Reg.group<VelocityComponent, PositionComponent>(entt::get<AccelerationComponent, BodyComponent>);
+        KinematicOrderSystem SysOrder(Reg);
+        SysOrder.sort();
+        _Suite.run("gravity/calculate_forces/"+std::to_string(Systems)+"x"+std::to_string(Objects)+"/ordered",
+                   [&]{SysGravity.calculateForces(true);}, Pairs);
+    }
+    // Few gravitators and many test particles, items are interactions
+    for (const auto& [Objects, Gravitators] : {std::pair{1000, 3}, std::pair{100000, 3}})
+    {
+        entt::registry Reg;
+        createSystems(Reg, 1, Objects, Gravitators);
+        GravitySystem SysGravity(Reg);
+
+        const auto Interactions = std::uint64_t(Gravitators) * (Gravitators-1) / 2 +
+                                  std::uint64_t(Objects-Gravitators) * Gravitators;
+        _Suite.run("gravity/calculate_forces/1x"+std::to_string(Objects)+"/"+std::to_string(Gravitators)+"_gravitators",
+                   [&]{SysGravity.calculateForces();}, Interactions);
+    }
+}
+
+void benchIntegrator(BenchmarkSuite& _Suite)
+{
+    for (auto n : {1000, 100000})
+    {
+        entt::registry Reg;
+        createSystems(Reg, n, 1);
+        IntegratorSystem SysIntegrator(Reg);
+
+        _Suite.run("integrator/integrate/"+std::to_string(n),
+                   [&]{SysIntegrator.integrate(0.01);}, n);
+    }
+}
+
+void benchLocalWorlds(BenchmarkSuite& _Suite)
+{
+    constexpr int Worlds = 64;
+    constexpr int Bodies = 32;
+
+    entt::registry Reg;
+    LocalWorldManager LocalWorlds(Reg);
+    for (auto i=0; i<Worlds; ++i) createLocalWorld(LocalWorlds, Reg.create(), Bodies);
+
+    // Items are worlds
+    for (auto Workers : {std::size_t(0), JobPool::getDefaultNumberOfWorkers()})
+    {
+        JobPool Jobs(Workers);
+        _Suite.run("local_worlds/step/"+std::to_string(Worlds)+"x"+std::to_string(Bodies)+
+                   "/workers_"+std::to_string(Workers),
+                   [&]{LocalWorlds.step(0.01f, Jobs);}, Worlds);
+    }
+}
+
+void benchName(BenchmarkSuite& _Suite)
+{
+    constexpr int n = 100000;
+
+    entt::registry Reg;
+    std::vector<entt::entity> Entities(n);
+    Reg.create(Entities.begin(), Entities.end());
+
+    std::vector<std::string> Names;
+    for (auto i=0; i<n; ++i) Names.push_back("Star_"+std::to_string(i));
+
+    NameSystem SysName(Reg);
+    _Suite.runOnce("name/set_name/"+std::to_string(n),
+                   [&]{Reg.clear<NameComponent>();},
+                   [&]
+                   {
+                       for (auto i=0; i<n; ++i) SysName.setName(Entities[i], Names[i]);
+                   }, n);
+
+    // Names and index are set up regardless of the filter, the lookups
+    // below need them
+    for (auto i=0; i<n; ++i) SysName.setName(Entities[i], Names[i]);
+
+    _Suite.runOnce("name/publish_index/"+std::to_string(n),
+                   [&]{SysName.setName(Entities[0], Names[0]);},
+                   [&]
+                   {
+                       SysName.publish();
+                       SysName.wait();
+                   }, n);
+
+    SysName.publish();
+    SysName.wait();
+    const auto Index = SysName.getIndex();
+
+    std::vector<NameIndex::Match> Matches;
+    _Suite.run("name/find/"+std::to_string(n),
+               [&]
+               {
+                   Matches.clear();
+                   Index->find("star_4711", NAME_SEARCH_RESULTS_MAX, Matches);
+                   doNotOptimise(Matches);
+               });
+    _Suite.run("name/find_prefix/"+std::to_string(n),
+               [&]
+               {
+                   Matches.clear();
+                   Index->findPrefix("Star_47", NAME_SEARCH_RESULTS_MAX, Matches);
+                   doNotOptimise(Matches);
+               });
+    _Suite.run("name/find_fuzzy/"+std::to_string(n),
+               [&]
+               {
+                   Matches.clear();
+                   Index->findFuzzy("Stra_4711", 2, NAME_SEARCH_RESULTS_MAX, Matches);
+                   doNotOptimise(Matches);
+               });
+}
+
+void benchParticles(BenchmarkSuite& _Suite)
+{
+    constexpr double AU{1.495978707e11};
+
+    // Items are particle-source interactions
+    for (const auto& [n, Sources] : {std::pair{100000, 1}, std::pair{1000000, 3}})
+    {
+        ParticlePopulation Particles;
+        Particles.addBelt(1, n, {0.0, 0.0}, {0.0, 0.0}, 1.9884e30, 2.2*AU, 3.3*AU);
+        const std::vector<ParticleSource> s{{0.0, 0.0, 1.9884e30}, {0.0, -152.1e9, 5.972e24}, {384400.0e3, -152.1e9, 7.346e22}};
+
+        _Suite.run("particles/integrate/"+std::to_string(n)+"x"+std::to_string(Sources),
+                   [&]{Particles.integrate(s.data(), Sources, 1000.0);}, std::uint64_t(n)*Sources);
+    }
+}
@@ -0,0 +1,191 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "timer.hpp"
+
+// Minimal, self-contained benchmark harness. Each benchmark is sampled
+// several times, results are given per operation (i.e. per call of the
+// benchmarked function or per item, if items per call are given).
+
+// Prevent compiler from optimising away results
+template<class T>
+inline void doNotOptimise(T& _v)
+{
+    asm volatile("" : : "r,m"(_v) : "memory");
+}
+
+struct BenchmarkResult
+{
+    std::string Name;
+    std::uint64_t Iterations{0};     // Calls per sample
+    std::uint64_t Samples{0};
+    std::uint64_t ItemsPerCall{1};
+    double NsMin{0.0};               // Per item
+    double NsMedian{0.0};
+    double NsMean{0.0};
+    double NsMax{0.0};
+};
+
+class BenchmarkSuite
+{
+
+    public:
+
+        void setFilter(const std::string& _Filter) {Filter_ = _Filter;}
+        void setMinSampleTime(double _t) {MinSampleTime_ = _t;}
+        void setSamples(std::uint64_t _n) {Samples_ = _n;}
+
+        bool isSelected(const std::string& _Name) const
+        {
+            return Filter_.empty() || _Name.find(Filter_) != std::string::npos;
+        }
+
+        // Function is called repeatedly, number of calls per sample is
+        // calibrated to reach minimum sample time
+        void run(const std::string& _Name, const std::function<void()>& _f, std::uint64_t _ItemsPerCall = 1);
+
+        // Function is called once per sample after an untimed setup, for
+        // benchmarks modifying their input (e.g. creating entities)
+        void runOnce(const std::string& _Name, const std::function<void()>& _Setup,
+                     const std::function<void()>& _f, std::uint64_t _ItemsPerCall = 1);
+
+        void writeJson(std::ostream& _s) const;
+        void writeText(std::ostream& _s) const;
+
+    private:
+
+        void addResult(const std::string& _Name, std::vector<double>& _SampleTimes,
+                       std::uint64_t _Iterations, std::uint64_t _ItemsPerCall);
+
+        std::vector<BenchmarkResult> Results_;
+        std::string Filter_;
+        double MinSampleTime_{0.05};
+        std::uint64_t Samples_{10};
+
+};
+
+inline void BenchmarkSuite::run(const std::string& _Name, const std::function<void()>& _f, std::uint64_t _ItemsPerCall)
+{
+    if (!this->isSelected(_Name)) return;
+
+    Timer t;
+
+    // Warm up and calibrate
+    std::uint64_t Iterations{1};
+    while (true)
+    {
+        t.start();
+        for (auto i=0u; i<Iterations; ++i) _f();
+        t.stop();
+        if (t.elapsed() >= MinSampleTime_ || Iterations >= (std::uint64_t(1) << 40)) break;
+        Iterations *= 2;
+    }
+
+    std::vector<double> SampleTimes;
+    for (auto s=0u; s<Samples_; ++s)
+    {
+        t.start();
+        for (auto i=0u; i<Iterations; ++i) _f();
+        t.stop();
+        SampleTimes.push_back(t.elapsed());
+    }
+    this->addResult(_Name, SampleTimes, Iterations, _ItemsPerCall);
+}
+
+inline void BenchmarkSuite::runOnce(const std::string& _Name, const std::function<void()>& _Setup,
+                                    const std::function<void()>& _f, std::uint64_t _ItemsPerCall)
+{
+    if (!this->isSelected(_Name)) return;
+
+    Timer t;
+    std::vector<double> SampleTimes;
+    for (auto s=0u; s<Samples_; ++s)
+    {
+        _Setup();
+        t.start();
+        _f();
+        t.stop();
+        SampleTimes.push_back(t.elapsed());
+    }
+    this->addResult(_Name, SampleTimes, 1, _ItemsPerCall);
+}
+
+inline void BenchmarkSuite::addResult(const std::string& _Name, std::vector<double>& _SampleTimes,
+                                      std::uint64_t _Iterations, std::uint64_t _ItemsPerCall)
+{
+    const double Scale = 1.0e9 / double(_Iterations * _ItemsPerCall);
+    std::sort(_SampleTimes.begin(), _SampleTimes.end());
+
+    BenchmarkResult r;
+    r.Name = _Name;
+    r.Iterations = _Iterations;
+    r.Samples = _SampleTimes.size();
+    r.ItemsPerCall = _ItemsPerCall;
+    r.NsMin = _SampleTimes.front() * Scale;
+    r.NsMax = _SampleTimes.back() * Scale;
+    r.NsMedian = _SampleTimes[_SampleTimes.size()/2] * Scale;
+    r.NsMean = std::accumulate(_SampleTimes.begin(), _SampleTimes.end(), 0.0) / _SampleTimes.size() * Scale;
+    Results_.push_back(r);
+
+    std::fprintf(stderr, "%-48s %14.2f ns/op\n", _Name.c_str(), r.NsMedian);
+}
+
+inline void BenchmarkSuite::writeJson(std::ostream& _s) const
+{
+    #ifdef NDEBUG
+        const char* Build = "release";
+    #else
+        const char* Build = "debug";
+    #endif
+
+    _s << "{\n  \"build\": \"" << Build << "\",\n  \"benchmarks\": [\n";
+    for (auto i=0u; i<Results_.size(); ++i)
+    {
+        const auto& r = Results_[i];
+        _s << "    {\"name\": \"" << r.Name << "\""
+           << ", \"iterations\": " << r.Iterations
+           << ", \"samples\": " << r.Samples
+           << ", \"items_per_call\": " << r.ItemsPerCall
+           << ", \"ns_per_op_min\": " << r.NsMin
+           << ", \"ns_per_op_median\": " << r.NsMedian
+           << ", \"ns_per_op_mean\": " << r.NsMean
+           << ", \"ns_per_op_max\": " << r.NsMax
+           << ", \"ops_per_second\": " << 1.0e9/r.NsMedian
+           << "}" << (i+1 < Results_.size() ? "," : "") << "\n";
+    }
+    _s << "  ]\n}\n";
+}
+
+inline void BenchmarkSuite::writeText(std::ostream& _s) const
+{
+    char Line[160];
+    std::snprintf(Line, sizeof(Line), "%-48s %14s %14s %14s\n", "Benchmark", "median ns/op", "min ns/op", "ops/s");
+    _s << Line;
+    for (const auto& r : Results_)
+    {
+        std::snprintf(Line, sizeof(Line), "%-48s %14.2f %14.2f %14.0f\n",
+                      r.Name.c_str(), r.NsMedian, r.NsMin, 1.0e9/r.NsMedian);
+        _s << Line;
+    }
+}
+
+// Benchmarks of the different components
+void benchGalaxy(BenchmarkSuite& _Suite);
+void benchGravity(BenchmarkSuite& _Suite);
+void benchIntegrator(BenchmarkSuite& _Suite);
+void benchJson(BenchmarkSuite& _Suite);
+void benchLocalWorlds(BenchmarkSuite& _Suite);
+void benchName(BenchmarkSuite& _Suite);
+void benchParse(BenchmarkSuite& _Suite);
+void benchParticles(BenchmarkSuite& _Suite);
+
+#endif // BENCHMARK_HPP
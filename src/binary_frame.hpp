@@ -0,0 +1,14 @@
+#ifndef BINARY_FRAME_HPP
+#define BINARY_FRAME_HPP
+
+#include <string>
+
+// Binary frames (particles, density, galaxy chunks) are plain data in host
+// byte order, appended field by field
+template<class T>
+inline void appendBinary(std::string& _Frame, const T& _v)
+{
+    _Frame.append(reinterpret_cast<const char*>(&_v), sizeof(T));
+}
+
+#endif // BINARY_FRAME_HPP
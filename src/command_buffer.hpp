@@ -0,0 +1,47 @@
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <functional>
+
+#include <concurrentqueue/concurrentqueue.h>
+#include <entt/entity/registry.hpp>
+
+// Structural changes to a registry (create, destroy, emplace, remove) are
+// recorded from any thread and applied by the thread owning the registry
+// at a defined point in its loop. Hence, iterating views doesn't need any
+// locking. Recording is lock-free.
+class CommandBuffer
+{
+
+    public:
+
+        using CommandType = std::function<void(entt::registry&)>;
+
+        explicit CommandBuffer(entt::registry& _Reg) : Reg_(_Reg) {}
+
+        void record(CommandType&& _Cmd) {Queue_.enqueue(std::move(_Cmd));}
+
+        std::size_t apply();
+
+    private:
+
+        entt::registry& Reg_;
+
+        moodycamel::ConcurrentQueue<CommandType> Queue_;
+
+};
+
+inline std::size_t CommandBuffer::apply()
+{
+    std::size_t NrOfCommands{0};
+
+    CommandType Cmd;
+    while (Queue_.try_dequeue(Cmd))
+    {
+        Cmd(Reg_);
+        ++NrOfCommands;
+    }
+    return NrOfCommands;
+}
+
+#endif // COMMAND_BUFFER_HPP
@@ -9,12 +9,8 @@ struct BodyComponent
     double i{1.0}; // inertia
 };
 
-struct StarDataComponent
-{
-    SpectralClassE SpectralClass{SpectralClassE::M};
-    double Temperature{3000.0};
-};
-
+// Source of gravity, bodies without are test particles feeling gravity
+// without producing it (see GravitySystem)
 struct GravitatorComponent{};
 
 #endif // BODY_COMPONENT_HPP
@@ -1,6 +1,8 @@
 #ifndef NAME_COMPONENT_HPP
 #define NAME_COMPONENT_HPP
 
+#include <charconv>
+#include <cstdint>
 #include <cstring>
 
 // 31 characters and trailing delimiter (\0)
@@ -13,4 +15,36 @@ struct NameComponent
     // to set names via string copy and test for length
     char Name[NAME_SIZE_MAX]{"Unknown"};
 };
+
+enum class ProceduralNameType : std::uint32_t
+{
+    STAR,
+    SYSTEM
+};
+
+// Prefix of procedural names, by type
+constexpr std::size_t PROCEDURAL_NAME_TYPES = 2;
+constexpr const char* PROCEDURAL_NAME_PREFIXES[PROCEDURAL_NAME_TYPES] = {"Star_", "System_"};
+
+// Name of a generated object, derived from its type and index on demand
+// (e.g. "Star_123") instead of being stored. An explicit NameComponent
+// takes precedence.
+struct ProceduralNameComponent
+{
+    ProceduralNameType Type{ProceduralNameType::STAR};
+    std::uint32_t Index{0};
+};
+
+// Writes the name to _Name (NAME_SIZE_MAX), returns its length
+inline std::size_t toProceduralName(const ProceduralNameComponent& _p, char* _Name)
+{
+    const char* Prefix = PROCEDURAL_NAME_PREFIXES[std::size_t(_p.Type)];
+    const auto n = std::strlen(Prefix);
+    std::memcpy(_Name, Prefix, n);
+    // Prefix and 10 digits always fit
+    auto* End = std::to_chars(_Name+n, _Name+NAME_SIZE_MAX-1, _p.Index).ptr;
+    *End = '\0';
+    return std::size_t(End - _Name);
+}
+
 #endif // NAME_COMPONENT_HPP
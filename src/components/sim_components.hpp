@@ -5,10 +5,13 @@
 #define SIM_COMPONENTS_HPP
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <box2d/box2d.h>
 #include <entt/entity/registry.hpp>
 
+#include "particle_population.hpp"
+
 struct TireComponent
 {
     constexpr static int SEGMENTS = 32;
@@ -20,10 +23,42 @@ struct TireComponent
     std::array<b2DistanceJoint*, SEGMENTS> TangentialJoints;
 };
 
+// Attached to the parent body or region of a local box2d world, see
+// LocalWorldManager
+struct LocalWorldComponent
+{
+    std::uint32_t Index{0};
+};
+
 struct StarSystemComponent
 {
     std::vector<entt::entity> Objects;
     int Seed{0};
+
+    // Members in the kinematic group, valid if ordered (see
+    // KinematicOrderSystem)
+    std::uint32_t Offset{0};
+    std::uint32_t Count{0};
+};
+
+// Attached to star systems with belts or rings, see ParticleSystem
+struct ParticlePopulationComponent
+{
+    ParticlePopulation Particles;
+    double CentralMass{0.0};    // Static star at origin, generated systems
+    double Lag{0.0};            // Time not integrated yet
+};
+
+// Belts of generated systems are materialised when first requested, until
+// then only their parameters are stored. They aren't populations yet, hence,
+// ParticleSystem doesn't visit them.
+struct PendingBeltComponent
+{
+    double CentralMass{0.0};
+    std::uint32_t Particles{0};
+    std::uint32_t Seed{0};
+    double RadiusMin{0.0};
+    double RadiusMax{0.0};
 };
 
 #endif // SIM_COMPONENTS_HPP
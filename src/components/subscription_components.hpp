@@ -2,6 +2,7 @@
 #define SUBSCRIPTION_COMPONENTS_HPP
 
 #include <array>
+#include <cstdint>
 
 #include <entt/entity/entity.hpp>
 
@@ -37,6 +38,7 @@ struct DynamicDataSubscriptionComponent{};
 struct GalaxyDataSubscriptionComponent
 {
     bool Transmitted{false};
+    std::uint32_t RequestID{0}; // Result is sent after transmission
 };
 
 #endif // SUBSCRIPTION_COMPONENTS_HPP
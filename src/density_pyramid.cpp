@@ -0,0 +1,101 @@
+#include "density_pyramid.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "binary_frame.hpp"
+#include "grid_bounds.hpp"
+#include "star_definitions.hpp"
+#include "star_table.hpp"
+
+namespace
+{
+    constexpr char DENSITY_FRAME_MAGIC[4] = {'P', 'W', 'D', 'P'};
+    constexpr std::size_t DENSITY_FRAME_HEADER_SIZE = 4 + 3*sizeof(std::uint32_t) + 3*sizeof(double);
+    constexpr std::size_t DENSITY_FRAME_REQUEST_ID_OFFSET = 4;
+}
+
+DensityPyramid::DensityPyramid(const StarTable& _Stars)
+{
+    // Square around all stars, so cells are square on every level
+    const auto Bounds = getGridBounds(_Stars.size(), [&_Stars](auto i){return _Stars.getX(i);},
+                                                     [&_Stars](auto i){return _Stars.getY(i);});
+    CellSize_ = Bounds.Extent / DENSITY_PYRAMID_SIZE;
+    OriginX_ = Bounds.OriginX;
+    OriginY_ = Bounds.OriginY;
+
+    Levels_.resize(DENSITY_PYRAMID_LEVELS);
+    for (auto l=0u; l<DENSITY_PYRAMID_LEVELS; ++l)
+    {
+        Levels_[l].resize(std::size_t(getSize(l))*getSize(l));
+    }
+
+    // Temperatures are summed up first and averaged once all levels are done
+    auto& Finest = Levels_[0];
+    for (auto i=0u; i<_Stars.size(); ++i)
+    {
+        const auto x = std::min(std::uint32_t((_Stars.getX(i)-OriginX_) / CellSize_), DENSITY_PYRAMID_SIZE-1);
+        const auto y = std::min(std::uint32_t((_Stars.getY(i)-OriginY_) / CellSize_), DENSITY_PYRAMID_SIZE-1);
+        const double r = _Stars.getRadius(i) / SOLAR_RADIUS;
+        const double t = _Stars.getTemperature(i) / SOLAR_TEMPERATURE;
+
+        auto& c = Finest[y*DENSITY_PYRAMID_SIZE + x];
+        ++c.Count;
+        c.Luminosity += float(r*r * t*t*t*t);
+        c.Temperature += _Stars.getTemperature(i);
+    }
+    for (auto l=1u; l<DENSITY_PYRAMID_LEVELS; ++l)
+    {
+        const auto n = getSize(l);
+        for (auto y=0u; y<n; ++y)
+        {
+            for (auto x=0u; x<n; ++x)
+            {
+                auto& c = Levels_[l][y*n + x];
+                for (auto k=0u; k<4; ++k)
+                {
+                    const auto& f = Levels_[l-1][(2*y + k/2)*2*n + 2*x + k%2];
+                    c.Count += f.Count;
+                    c.Luminosity += f.Luminosity;
+                    c.Temperature += f.Temperature;
+                }
+            }
+        }
+    }
+    for (auto l=0u; l<DENSITY_PYRAMID_LEVELS; ++l)
+    {
+        for (auto& c : Levels_[l])
+        {
+            if (c.Count > 0) c.Temperature /= float(c.Count);
+        }
+        this->encode(l);
+    }
+}
+
+std::string DensityPyramid::getFrame(std::uint32_t _Level, std::uint32_t _RequestID) const
+{
+    auto Frame = Frames_[_Level];
+    std::memcpy(&Frame[DENSITY_FRAME_REQUEST_ID_OFFSET], &_RequestID, sizeof(_RequestID));
+    return Frame;
+}
+
+void DensityPyramid::encode(std::uint32_t _Level)
+{
+    const auto n = getSize(_Level);
+
+    auto& Frame = Frames_.emplace_back();
+    Frame.reserve(DENSITY_FRAME_HEADER_SIZE + Levels_[_Level].size()*sizeof(Cell));
+    Frame.append(DENSITY_FRAME_MAGIC, sizeof(DENSITY_FRAME_MAGIC));
+    appendBinary(Frame, std::uint32_t(0));
+    appendBinary(Frame, _Level);
+    appendBinary(Frame, n);
+    appendBinary(Frame, OriginX_);
+    appendBinary(Frame, OriginY_);
+    appendBinary(Frame, CellSize_ * (DENSITY_PYRAMID_SIZE / n));
+    for (const auto& c : Levels_[_Level])
+    {
+        appendBinary(Frame, c.Count);
+        appendBinary(Frame, c.Luminosity);
+        appendBinary(Frame, c.Temperature);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef DENSITY_PYRAMID_HPP
+#define DENSITY_PYRAMID_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class StarTable;
+
+// Cells per side of the finest level, coarser levels halve it down to 1x1
+constexpr std::uint32_t DENSITY_PYRAMID_SIZE = 256;
+constexpr std::uint32_t DENSITY_PYRAMID_LEVELS = 9;
+
+// Mip pyramid of the galaxy for zoomed-out clients. Each level is a square
+// grid of star count, total luminosity (solar luminosities) and mean
+// temperature per cell, level 0 being the finest. Stars are static, hence,
+// the pyramid is built once after generation and shared read-only.
+// Levels are encoded as binary frames when building, a request only copies
+// a frame and patches its request ID.
+//
+// Frame format (little endian):
+//   magic "PWDP", request ID (u32), level (u32), cells per side n (u32),
+//   origin x, origin y, cell size (f64, m), n*n cells row by row starting
+//   at origin: count (u32), luminosity (f32), mean temperature (f32, K)
+class DensityPyramid
+{
+
+    public:
+
+        struct Cell
+        {
+            std::uint32_t Count{0};
+            float Luminosity{0.0f};
+            float Temperature{0.0f};
+        };
+
+        explicit DensityPyramid(const StarTable& _Stars);
+
+        static std::uint32_t getSize(std::uint32_t _Level) {return DENSITY_PYRAMID_SIZE >> _Level;}
+
+        const Cell& getCell(std::uint32_t _Level, std::uint32_t _x, std::uint32_t _y) const
+        {
+            return Levels_[_Level][_y*getSize(_Level) + _x];
+        }
+
+        // Binary frame of the given level, _Level < DENSITY_PYRAMID_LEVELS
+        std::string getFrame(std::uint32_t _Level, std::uint32_t _RequestID) const;
+
+    private:
+
+        void encode(std::uint32_t _Level);
+
+        double OriginX_{0.0};
+        double OriginY_{0.0};
+        double CellSize_{1.0};    // Of finest level
+
+        std::vector<std::vector<Cell>> Levels_;
+        std::vector<std::string>       Frames_;
+
+};
+
+#endif // DENSITY_PYRAMID_HPP
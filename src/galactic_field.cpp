@@ -0,0 +1,120 @@
+#include "galactic_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "grid_bounds.hpp"
+#include "star_table.hpp"
+
+namespace
+{
+    constexpr double G{6.6743e-11};
+
+    // Margin around the stars, so the field just outside of the galaxy is
+    // still resolved by the grid
+    constexpr double MARGIN{0.125};
+
+    constexpr std::uint32_t NODES = GALACTIC_FIELD_SIZE*GALACTIC_FIELD_SIZE;
+}
+
+GalacticField::GalacticField(const StarTable& _Stars) :
+    AX_(NODES, 0.0), AY_(NODES, 0.0)
+{
+    this->setGeometry(_Stars);
+    std::vector<double> Masses(NODES, 0.0);
+    this->deposit(_Stars, Masses);
+    for (auto i=0u; i<NODES; ++i)
+    {
+        if (Masses[i] != 0.0) this->addNode(i, Masses[i]);
+    }
+}
+
+Vec2Dd GalacticField::getAcceleration(const Vec2Dd& _Position) const
+{
+    const auto x = (_Position(0) - OriginX_) / Spacing_;
+    const auto y = (_Position(1) - OriginY_) / Spacing_;
+    constexpr double Max = GALACTIC_FIELD_SIZE-1;
+    if (!(x >= 0.0 && y >= 0.0 && x <= Max && y <= Max))
+    {
+        if (MassTotal_ == 0.0) return {0.0, 0.0};
+        const Vec2Dd d = CentreOfMass_ - _Position;
+        const auto r = d.norm();
+        return G * MassTotal_ / (r*r*r) * d;
+    }
+
+    const auto i = std::min(std::uint32_t(x), GALACTIC_FIELD_SIZE-2);
+    const auto j = std::min(std::uint32_t(y), GALACTIC_FIELD_SIZE-2);
+    const auto fx = x - i;
+    const auto fy = y - j;
+    const auto n00 = j*GALACTIC_FIELD_SIZE + i;
+    const auto n10 = n00 + 1;
+    const auto n01 = n00 + GALACTIC_FIELD_SIZE;
+    const auto n11 = n01 + 1;
+    const auto w00 = (1.0-fx)*(1.0-fy);
+    const auto w10 = fx*(1.0-fy);
+    const auto w01 = (1.0-fx)*fy;
+    const auto w11 = fx*fy;
+    return {w00*AX_[n00] + w10*AX_[n10] + w01*AX_[n01] + w11*AX_[n11],
+            w00*AY_[n00] + w10*AY_[n10] + w01*AY_[n01] + w11*AY_[n11]};
+}
+
+void GalacticField::addNode(std::uint32_t _Node, double _Mass)
+{
+    const auto xs = double(_Node % GALACTIC_FIELD_SIZE);
+    const auto ys = double(_Node / GALACTIC_FIELD_SIZE);
+
+    // Positions in units of the node spacing, softened by one spacing
+    const auto k = G * _Mass / (Spacing_*Spacing_);
+    for (auto j=0u; j<GALACTIC_FIELD_SIZE; ++j)
+    {
+        const auto dy = ys - j;
+        auto* AX = &AX_[j*GALACTIC_FIELD_SIZE];
+        auto* AY = &AY_[j*GALACTIC_FIELD_SIZE];
+        for (auto i=0u; i<GALACTIC_FIELD_SIZE; ++i)
+        {
+            const auto dx = xs - i;
+            const auto r2 = dx*dx + dy*dy + 1.0;
+            const auto f = k / (r2*std::sqrt(r2));
+            AX[i] += f*dx;
+            AY[i] += f*dy;
+        }
+    }
+
+    const auto Position = Vec2Dd{OriginX_ + xs*Spacing_, OriginY_ + ys*Spacing_};
+    const auto MassTotal = MassTotal_ + _Mass;
+    if (MassTotal != 0.0) CentreOfMass_ = (CentreOfMass_*MassTotal_ + Position*_Mass) / MassTotal;
+    MassTotal_ = MassTotal;
+    ++NumberOfMassNodes_;
+}
+
+void GalacticField::deposit(const StarTable& _Stars, std::vector<double>& _Masses) const
+{
+    // The grid encloses all stars, see setGeometry
+    for (auto s=0u; s<_Stars.size(); ++s)
+    {
+        const auto x = (_Stars.getX(s) - OriginX_) / Spacing_;
+        const auto y = (_Stars.getY(s) - OriginY_) / Spacing_;
+
+        const auto i = std::min(std::uint32_t(x), GALACTIC_FIELD_SIZE-2);
+        const auto j = std::min(std::uint32_t(y), GALACTIC_FIELD_SIZE-2);
+        const auto fx = x - i;
+        const auto fy = y - j;
+        const double m = _Stars.getMass(s);
+        const auto n = j*GALACTIC_FIELD_SIZE + i;
+        _Masses[n] += (1.0-fx)*(1.0-fy)*m;
+        _Masses[n+1] += fx*(1.0-fy)*m;
+        _Masses[n+GALACTIC_FIELD_SIZE] += (1.0-fx)*fy*m;
+        _Masses[n+GALACTIC_FIELD_SIZE+1] += fx*fy*m;
+    }
+}
+
+void GalacticField::setGeometry(const StarTable& _Stars)
+{
+    if (_Stars.size() == 0) return;
+
+    const auto Bounds = getGridBounds(_Stars.size(), [&_Stars](auto i){return _Stars.getX(i);},
+                                                     [&_Stars](auto i){return _Stars.getY(i);}, MARGIN);
+    Spacing_ = Bounds.Extent / (GALACTIC_FIELD_SIZE-1);
+    OriginX_ = Bounds.OriginX;
+    OriginY_ = Bounds.OriginY;
+}
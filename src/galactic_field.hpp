@@ -0,0 +1,56 @@
+#ifndef GALACTIC_FIELD_HPP
+#define GALACTIC_FIELD_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "math_types.hpp"
+
+class StarTable;
+
+// Grid nodes per side
+constexpr std::uint32_t GALACTIC_FIELD_SIZE = 128;
+
+// Gravitational field of the galaxy's stars on a square grid. Masses are
+// assigned to the grid nodes (cloud in cell), the field at each node is
+// summed up over all nodes holding mass, softened by the node spacing.
+// Lookups interpolate bilinearly, outside the grid the galaxy is a point
+// mass at its centre of mass. Hence, accelerations are O(1), independent
+// of the number of stars.
+// Built once for the stars at t = 0, i.e. positions are looked up in the
+// frame of the star table. Stars move with the rotation curve derived from
+// it, see GalacticRotation.
+class GalacticField
+{
+
+    public:
+
+        explicit GalacticField(const StarTable& _Stars);
+
+        Vec2Dd getAcceleration(const Vec2Dd& _Position) const;
+
+        // Nodes holding mass, for statistics
+        std::size_t getNumberOfMassNodes() const {return NumberOfMassNodes_;}
+
+    private:
+
+        void addNode(std::uint32_t _Node, double _Mass);
+        void deposit(const StarTable& _Stars, std::vector<double>& _Masses) const;
+        void setGeometry(const StarTable& _Stars);
+
+        double OriginX_{0.0};
+        double OriginY_{0.0};
+        double Spacing_{1.0};
+
+        // Monopole outside of the grid
+        double MassTotal_{0.0};
+        Vec2Dd CentreOfMass_{0.0, 0.0};
+
+        std::vector<double> AX_;
+        std::vector<double> AY_;
+
+        std::size_t NumberOfMassNodes_{0};
+
+};
+
+#endif // GALACTIC_FIELD_HPP
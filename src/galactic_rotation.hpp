@@ -0,0 +1,111 @@
+#ifndef GALACTIC_ROTATION_HPP
+#define GALACTIC_ROTATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "galactic_field.hpp"
+#include "math_types.hpp"
+#include "star_table.hpp"
+
+// Samples of the rotation curve, radii and directions to average over
+constexpr std::size_t ROTATION_CURVE_SIZE = 256;
+constexpr std::size_t ROTATION_CURVE_DIRECTIONS = 32;
+
+// Rotation of the galaxy. Positions of stars are an analytic function of
+// time, evaluated when they are queried or serialised. Hence, star motion
+// is neither integrated nor stored, reading a position costs a rotation by
+// an angle proportional to time. Stars move on circular orbits around the
+// galactic center, the rotation curve is derived from the galactic field:
+// the radial acceleration a(r), averaged over all directions, gives the
+// angular velocity
+//   w(r) = sqrt(a(r) / r)
+// It is sampled at equidistant radii up to the outermost star and
+// interpolated linearly. Within the first sample, the galaxy rotates as a
+// solid body, beyond the last one, it is a point mass.
+// Stored (generated) positions are the positions at t = 0.
+class GalacticRotation
+{
+
+    public:
+
+        // No rotation, until derived from a field
+        GalacticRotation() : AngularVelocities_(2, 0.0) {}
+
+        GalacticRotation(const GalacticField& _Field, const StarTable& _Stars) :
+            AngularVelocities_(ROTATION_CURVE_SIZE, 0.0)
+        {
+            double RadiusMax{1.0};
+            for (auto i=0u; i<_Stars.size(); ++i)
+            {
+                RadiusMax = std::max(RadiusMax, std::hypot(_Stars.getX(i), _Stars.getY(i)));
+            }
+            RadiusStep_ = RadiusMax / ROTATION_CURVE_SIZE;
+
+            for (auto k=0u; k<ROTATION_CURVE_SIZE; ++k)
+            {
+                const auto r = (k+1) * RadiusStep_;
+                double a{0.0};
+                for (auto d=0u; d<ROTATION_CURVE_DIRECTIONS; ++d)
+                {
+                    const auto Angle = 2.0*MATH_PI * d / ROTATION_CURVE_DIRECTIONS;
+                    const Vec2Dd e{std::cos(Angle), std::sin(Angle)};
+                    a -= _Field.getAcceleration(r*e).dot(e);
+                }
+                a /= ROTATION_CURVE_DIRECTIONS;
+                AngularVelocities_[k] = std::sqrt(std::max(a, 0.0) / r);
+            }
+        }
+
+        double getAngularVelocity(double _r) const
+        {
+            const auto u = std::max(_r / RadiusStep_ - 1.0, 0.0);
+            const auto Last = double(AngularVelocities_.size()-1);
+            if (u >= Last)
+            {
+                const auto q = (Last+1.0) * RadiusStep_ / _r;
+                return AngularVelocities_.back() * q*std::sqrt(q);
+            }
+            const auto k = std::size_t(u);
+            const auto f = u - k;
+            return (1.0-f)*AngularVelocities_[k] + f*AngularVelocities_[k+1];
+        }
+
+        Vec2Dd getPosition(const Vec2Dd& _p0, double _t) const
+        {
+            const auto a = _t * this->getAngularVelocity(_p0.norm());
+            const auto c = std::cos(a);
+            const auto s = std::sin(a);
+            return {_p0(0)*c - _p0(1)*s, _p0(0)*s + _p0(1)*c};
+        }
+
+        // Bulk evaluation of columns (see StarTable). Angles are looked up
+        // in a separate pass, hence, the rotation itself vectorises.
+        void getPositions(std::size_t _n, const double* _X0, const double* _Y0, double _t,
+                          double* _X, double* _Y) const
+        {
+            for (std::size_t i=0; i<_n; ++i)
+            {
+                _Y[i] = _t * this->getAngularVelocity(std::sqrt(_X0[i]*_X0[i] + _Y0[i]*_Y0[i]));
+            }
+            for (std::size_t i=0; i<_n; ++i)
+            {
+                const auto x = _X0[i];
+                const auto y = _Y0[i];
+                const auto c = std::cos(_Y[i]);
+                const auto s = std::sin(_Y[i]);
+                _X[i] = x*c - y*s;
+                _Y[i] = x*s + y*c;
+            }
+        }
+
+    private:
+
+        std::vector<double> AngularVelocities_;   // At radii (k+1) * RadiusStep_
+        double RadiusStep_{1.0};
+
+};
+
+#endif // GALACTIC_ROTATION_HPP
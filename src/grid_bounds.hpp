@@ -0,0 +1,60 @@
+#ifndef GRID_BOUNDS_HPP
+#define GRID_BOUNDS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Square covered by a grid, so cells are square
+struct GridBounds
+{
+    double OriginX{0.0};    // Lower left corner
+    double OriginY{0.0};
+    double Extent{1.0};     // Side length
+};
+
+// Slightly larger than the points, so points at the border don't fall off
+// the grid
+constexpr double GRID_BOUNDS_TOLERANCE{1.0e-6};
+
+// Square around all points, _GetX(i) and _GetY(i) for i < _n. _Margin is
+// added on each side, relative to the extent of the points.
+template<class GetX, class GetY>
+GridBounds getGridBounds(std::size_t _n, GetX _GetX, GetY _GetY, double _Margin = 0.0)
+{
+    GridBounds Bounds;
+    if (_n == 0) return Bounds;
+
+    auto MinX = std::numeric_limits<double>::max();
+    auto MinY = std::numeric_limits<double>::max();
+    auto MaxX = std::numeric_limits<double>::lowest();
+    auto MaxY = std::numeric_limits<double>::lowest();
+    for (std::size_t i=0; i<_n; ++i)
+    {
+        MinX = std::min(MinX, _GetX(i));
+        MinY = std::min(MinY, _GetY(i));
+        MaxX = std::max(MaxX, _GetX(i));
+        MaxY = std::max(MaxY, _GetY(i));
+    }
+    Bounds.Extent = std::max({MaxX-MinX, MaxY-MinY, 1.0}) * (1.0 + 2.0*_Margin + GRID_BOUNDS_TOLERANCE);
+    Bounds.OriginX = 0.5*(MinX+MaxX) - 0.5*Bounds.Extent;
+    Bounds.OriginY = 0.5*(MinY+MaxY) - 0.5*Bounds.Extent;
+    return Bounds;
+}
+
+// Square around all points, centred at the origin (e.g. belts and rings
+// around their star system)
+template<class GetX, class GetY>
+GridBounds getCentredGridBounds(std::size_t _n, GetX _GetX, GetY _GetY)
+{
+    double HalfExtent{1.0};
+    for (std::size_t i=0; i<_n; ++i)
+    {
+        HalfExtent = std::max({HalfExtent, std::abs(_GetX(i)), std::abs(_GetY(i))});
+    }
+    HalfExtent *= 1.0 + GRID_BOUNDS_TOLERANCE;
+    return {-HalfExtent, -HalfExtent, 2.0*HalfExtent};
+}
+
+#endif // GRID_BOUNDS_HPP
@@ -0,0 +1,161 @@
+#include "input_log.hpp"
+
+#include <cstring>
+
+namespace
+{
+    constexpr char          MAGIC[8] = {'P', 'W', 'N', 'G', 'I', 'N', 'P', 'T'};
+    constexpr std::uint32_t VERSION = 2;
+
+    template<class T>
+    bool readValue(std::FILE* _f, T& _v)
+    {
+        return std::fread(&_v, sizeof(T), 1, _f) == 1;
+    }
+
+    template<class T>
+    void writeValue(std::FILE* _f, const T& _v)
+    {
+        std::fwrite(&_v, sizeof(T), 1, _f);
+    }
+}
+
+InputLogWriter::InputLogWriter(const std::string& _FileName)
+{
+    File_ = std::fopen(_FileName.c_str(), "wb");
+}
+
+void InputLogWriter::begin(std::uint32_t _Seed, std::uint32_t _StepSize)
+{
+    if (File_ == nullptr) return;
+
+    std::fwrite(MAGIC, sizeof(MAGIC), 1, File_);
+    writeValue(File_, VERSION);
+    writeValue(File_, _Seed);
+    writeValue(File_, _StepSize);
+}
+
+void InputLogWriter::end()
+{
+    if (File_ == nullptr) return;
+
+    this->write(InputLogRecordType::END, {});
+    std::fclose(File_);
+    File_ = nullptr;
+}
+
+void InputLogWriter::write(InputLogRecordType _t, const NetworkCommand& _c)
+{
+    if (File_ == nullptr) return;
+
+    // Ticks are monotonic, hence, deltas are small and stored as varint
+    auto Delta = Tick_ - TickLast_;
+    TickLast_ = Tick_;
+    while (Delta >= 0x80)
+    {
+        std::fputc(int(Delta & 0x7F) | 0x80, File_);
+        Delta >>= 7;
+    }
+    std::fputc(int(Delta), File_);
+
+    writeValue(File_, std::uint8_t(_t));
+    writeValue(File_, std::uint32_t(entt::to_integral(_c.ClientID)));
+    if (_t == InputLogRecordType::COMMAND)
+    {
+        writeValue(File_, _c.RequestID);
+        writeValue(File_, std::uint8_t(_c.Method));
+        writeValue(File_, std::uint8_t(_c.Class));
+        writeValue(File_, _c.Number);
+        writeValue(File_, _c.Number2);
+    }
+    ++NumberOfRecords_;
+}
+
+InputLogReader::InputLogReader(const std::string& _FileName)
+{
+    File_ = std::fopen(_FileName.c_str(), "rb");
+    if (File_ == nullptr) return;
+
+    char Magic[sizeof(MAGIC)];
+    std::uint32_t Version{0};
+    if (std::fread(Magic, sizeof(Magic), 1, File_) != 1 ||
+        std::memcmp(Magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readValue(File_, Version) || Version != VERSION ||
+        !readValue(File_, Seed_) ||
+        !readValue(File_, StepSize_))
+    {
+        std::fclose(File_);
+        File_ = nullptr;
+    }
+}
+
+InputLogReader::~InputLogReader()
+{
+    if (File_ != nullptr) std::fclose(File_);
+}
+
+bool InputLogReader::next(std::uint64_t _Tick, InputLogRecord& _r)
+{
+    if (IsFinished_) return false;
+
+    if (!HasPending_)
+    {
+        // A truncated log (e.g. server crashed) ends like a regular one
+        if (!this->read(Pending_))
+        {
+            IsFinished_ = true;
+            return false;
+        }
+        HasPending_ = true;
+    }
+    if (Pending_.Tick > _Tick) return false;
+
+    HasPending_ = false;
+    if (Pending_.Type == InputLogRecordType::END)
+    {
+        IsFinished_ = true;
+        return false;
+    }
+    _r = Pending_;
+    return true;
+}
+
+bool InputLogReader::read(InputLogRecord& _r)
+{
+    if (File_ == nullptr) return false;
+
+    std::uint64_t Delta{0};
+    for (int Shift=0; Shift<64; Shift+=7)
+    {
+        const int c = std::fgetc(File_);
+        if (c == EOF) return false;
+        Delta |= std::uint64_t(c & 0x7F) << Shift;
+        if ((c & 0x80) == 0) break;
+    }
+    TickLast_ += Delta;
+
+    std::uint8_t Type{0};
+    std::uint32_t ClientID{0};
+    if (!readValue(File_, Type) || !readValue(File_, ClientID)) return false;
+
+    _r = InputLogRecord{};
+    _r.Tick = TickLast_;
+    _r.Type = InputLogRecordType(Type);
+    _r.Command.ClientID = entt::entity(ClientID);
+    if (_r.Type == InputLogRecordType::COMMAND)
+    {
+        std::uint8_t Method{0};
+        std::uint8_t Class{0};
+        if (!readValue(File_, _r.Command.RequestID) ||
+            !readValue(File_, Method) ||
+            !readValue(File_, Class) ||
+            !readValue(File_, _r.Command.Number) ||
+            !readValue(File_, _r.Command.Number2))
+        {
+            return false;
+        }
+        _r.Command.Method = NetworkMethodType(Method);
+        _r.Command.Class = NetworkMessageClassificationType(Class);
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef INPUT_LOG_HPP
+#define INPUT_LOG_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <entt/entity/entity.hpp>
+
+#include "network_command.hpp"
+
+// Binary log of all inputs changing the simulation, i.e. commands entering
+// the simulation queue and client connections. Each record is tagged with
+// the sim tick it was applied in. Replaying a log against a galaxy of the
+// same seed reproduces the recorded session without network, e.g. to
+// compare tick cost across builds.
+//
+// Format (host byte order):
+//   Header: magic "PWNGINPT", version (u32), seed (u32), step size in ms (u32)
+//   Record: tick delta (varint), type (u8), client ID (u32), and for
+//           commands: request ID (u32), method (u8), class (u8), numbers of
+//           a pair (2 x f64)
+//
+// Writer and reader are only used by the simulation thread.
+
+enum class InputLogRecordType : std::uint8_t
+{
+    COMMAND,
+    CONNECT,
+    DISCONNECT,
+    END         // Last tick of the recording
+};
+
+struct InputLogRecord
+{
+    std::uint64_t Tick{0};
+    InputLogRecordType Type{InputLogRecordType::END};
+    NetworkCommand Command;
+};
+
+class InputLogWriter
+{
+
+    public:
+
+        explicit InputLogWriter(const std::string& _FileName);
+        ~InputLogWriter() {this->end();}
+        InputLogWriter(const InputLogWriter&) = delete;
+        InputLogWriter& operator=(const InputLogWriter&) = delete;
+
+        bool isOpen() const {return File_ != nullptr;}
+        std::uint64_t getNumberOfRecords() const {return NumberOfRecords_;}
+
+        void begin(std::uint32_t _Seed, std::uint32_t _StepSize);
+        void end();
+
+        void setTick(std::uint64_t _Tick) {Tick_ = _Tick;}
+        void recordCommand(const NetworkCommand& _c) {this->write(InputLogRecordType::COMMAND, _c);}
+        void recordConnect(entt::entity _ClientID) {this->write(InputLogRecordType::CONNECT, {_ClientID});}
+        void recordDisconnect(entt::entity _ClientID) {this->write(InputLogRecordType::DISCONNECT, {_ClientID});}
+
+    private:
+
+        void write(InputLogRecordType _t, const NetworkCommand& _c);
+
+        std::FILE*    File_{nullptr};
+        std::uint64_t Tick_{0};
+        std::uint64_t TickLast_{0};
+        std::uint64_t NumberOfRecords_{0};
+
+};
+
+class InputLogReader
+{
+
+    public:
+
+        explicit InputLogReader(const std::string& _FileName);
+        ~InputLogReader();
+        InputLogReader(const InputLogReader&) = delete;
+        InputLogReader& operator=(const InputLogReader&) = delete;
+
+        // False, if file couldn't be opened or header is invalid
+        bool isOpen() const {return File_ != nullptr;}
+        bool isFinished() const {return IsFinished_;}
+        std::uint32_t getSeed() const {return Seed_;}
+        std::uint32_t getStepSize() const {return StepSize_;}
+
+        // Returns the next record, if it belongs to the given tick
+        bool next(std::uint64_t _Tick, InputLogRecord& _r);
+
+    private:
+
+        bool read(InputLogRecord& _r);
+
+        std::FILE*     File_{nullptr};
+        std::uint32_t  Seed_{0};
+        std::uint32_t  StepSize_{0};
+        std::uint64_t  TickLast_{0};
+        InputLogRecord Pending_;
+        bool           HasPending_{false};
+        bool           IsFinished_{false};
+
+};
+
+#endif // INPUT_LOG_HPP
@@ -0,0 +1,136 @@
+#include "job_pool.hpp"
+
+#include "trace.hpp"
+
+namespace
+{
+    // Pool and queue of the current thread, if it is a worker
+    thread_local const JobPool* ThisPool{nullptr};
+    thread_local std::size_t    ThisQueue{0};
+}
+
+JobPool::JobPool(std::size_t _NumberOfWorkers)
+{
+    for (auto i=0u; i<_NumberOfWorkers+1; ++i)
+    {
+        Queues_.push_back(std::make_unique<Queue>());
+    }
+    for (auto i=0u; i<_NumberOfWorkers; ++i)
+    {
+        Workers_.emplace_back(&JobPool::run, this, i);
+    }
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        IsStopped_ = true;
+    }
+    Condition_.notify_all();
+    for (auto& w : Workers_) w.join();
+}
+
+void JobPool::submit(JobType _Job, JobCounter& _Counter)
+{
+    // Counted before queueing, so Pending_ never underflows
+    _Counter.Count_.fetch_add(1, std::memory_order_relaxed);
+    Pending_.fetch_add(1, std::memory_order_release);
+    {
+        auto& q = *Queues_[this->getQueueIndex()];
+        std::lock_guard<std::mutex> Lock(q.Lock);
+        q.Jobs.push_back({std::move(_Job), &_Counter});
+    }
+
+    // Sleeping workers check for pending jobs while holding the lock
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+    }
+    Condition_.notify_one();
+}
+
+void JobPool::wait(const JobCounter& _Counter)
+{
+    const auto Index = this->getQueueIndex();
+    while (!_Counter.isDone())
+    {
+        if (!this->tryExecute(Index)) std::this_thread::yield();
+    }
+}
+
+void JobPool::parallelFor(std::size_t _n, const std::function<void(std::size_t)>& _f)
+{
+    // Not worth involving the workers
+    if (_n == 1 || Workers_.empty())
+    {
+        for (auto i=0u; i<_n; ++i) _f(i);
+        return;
+    }
+
+    JobCounter Counter;
+    for (auto i=0u; i<_n; ++i)
+    {
+        this->submit([&_f, i]{_f(i);}, Counter);
+    }
+    this->wait(Counter);
+}
+
+std::size_t JobPool::getQueueIndex() const
+{
+    return ThisPool == this ? ThisQueue : Workers_.size();
+}
+
+bool JobPool::tryExecute(std::size_t _Queue)
+{
+    if (Pending_.load(std::memory_order_acquire) == 0) return false;
+
+    Job j;
+    bool IsFound{false};
+
+    // Own queue first, newest jobs are most likely to be hot in cache
+    {
+        auto& q = *Queues_[_Queue];
+        std::lock_guard<std::mutex> Lock(q.Lock);
+        if (!q.Jobs.empty())
+        {
+            j = std::move(q.Jobs.back());
+            q.Jobs.pop_back();
+            IsFound = true;
+        }
+    }
+    // Steal oldest jobs from others
+    for (auto i=1u; !IsFound && i<Queues_.size(); ++i)
+    {
+        auto& q = *Queues_[(_Queue+i) % Queues_.size()];
+        std::lock_guard<std::mutex> Lock(q.Lock);
+        if (!q.Jobs.empty())
+        {
+            j = std::move(q.Jobs.front());
+            q.Jobs.pop_front();
+            IsFound = true;
+        }
+    }
+    if (!IsFound) return false;
+
+    Pending_.fetch_sub(1, std::memory_order_relaxed);
+    j.Run();
+    j.Counter->Count_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobPool::run(std::size_t _Queue)
+{
+    TRACE_THREAD("worker");
+
+    ThisPool = this;
+    ThisQueue = _Queue;
+
+    while (true)
+    {
+        if (this->tryExecute(_Queue)) continue;
+
+        std::unique_lock<std::mutex> Lock(Lock_);
+        Condition_.wait(Lock, [this]{return IsStopped_ || Pending_.load(std::memory_order_acquire) > 0;});
+        if (IsStopped_) break;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef JOB_POOL_HPP
+#define JOB_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the outstanding jobs of a group, see JobPool::submit and
+// JobPool::wait
+class JobCounter
+{
+
+    public:
+
+        bool isDone() const {return Count_.load(std::memory_order_acquire) == 0;}
+
+    private:
+
+        friend class JobPool;
+
+        std::atomic<std::size_t> Count_{0};
+};
+
+// Work stealing pool of worker threads for the jobs of a tick. Each worker
+// takes jobs from the back of its own queue and steals from the front of
+// other queues if it runs out of work. Threads not belonging to the pool
+// share an additional queue. Waiting threads execute jobs instead of
+// blocking, hence, jobs may submit and wait for further jobs.
+class JobPool
+{
+
+    public:
+
+        using JobType = std::function<void()>;
+
+        explicit JobPool(std::size_t _NumberOfWorkers = getDefaultNumberOfWorkers());
+        ~JobPool();
+        JobPool(const JobPool&) = delete;
+        JobPool& operator=(const JobPool&) = delete;
+
+        static std::size_t getDefaultNumberOfWorkers()
+        {
+            return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+        std::size_t getNumberOfWorkers() const {return Workers_.size();}
+
+        void submit(JobType _Job, JobCounter& _Counter);
+        void wait(const JobCounter& _Counter);
+
+        // Calls _f(i) for all i in [0, _n), returns when all calls are done
+        void parallelFor(std::size_t _n, const std::function<void(std::size_t)>& _f);
+
+    private:
+
+        struct Job
+        {
+            JobType     Run;
+            JobCounter* Counter{nullptr};
+        };
+
+        struct Queue
+        {
+            std::mutex      Lock;
+            std::deque<Job> Jobs;
+        };
+
+        std::size_t getQueueIndex() const;
+        bool tryExecute(std::size_t _Queue);
+        void run(std::size_t _Queue);
+
+        // One per worker, the last one is shared by external threads
+        std::vector<std::unique_ptr<Queue>> Queues_;
+        std::vector<std::thread>            Workers_;
+
+        std::atomic<std::size_t> Pending_{0};
+
+        std::mutex              Lock_;
+        std::condition_variable Condition_;
+        bool                    IsStopped_{false};
+
+};
+
+#endif // JOB_POOL_HPP
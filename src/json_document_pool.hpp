@@ -0,0 +1,112 @@
+#ifndef JSON_DOCUMENT_POOL_HPP
+#define JSON_DOCUMENT_POOL_HPP
+
+#include <memory>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+// Document type for incoming requests. Values and parser stack both use
+// memory pool allocators, hence, the value type is rapidjson::Value.
+using JsonDocumentType = rapidjson::GenericDocument<rapidjson::UTF8<>,
+                                                    rapidjson::MemoryPoolAllocator<>,
+                                                    rapidjson::MemoryPoolAllocator<>>;
+
+// Documents for parsing incoming requests are recycled instead of being
+// allocated per message. Each document parses into an arena backed by a
+// fixed buffer, so typical requests don't touch the heap at all. Larger
+// requests allocate additional chunks, which are freed when the document
+// is returned to the pool.
+// The pool is not thread-safe, it is meant to be used by the thread
+// processing incoming messages.
+class JsonDocumentPool
+{
+
+    public:
+
+        static constexpr std::size_t ARENA_SIZE = 16384;
+        static constexpr std::size_t STACK_SIZE = 4096;
+
+        class PooledDocument
+        {
+            public:
+
+                PooledDocument() : Allocator_(Arena_, ARENA_SIZE),
+                                   StackAllocator_(Stack_, STACK_SIZE),
+                                   Doc_(&Allocator_, STACK_SIZE/2, &StackAllocator_) {}
+                PooledDocument(const PooledDocument&) = delete;
+                PooledDocument& operator=(const PooledDocument&) = delete;
+
+                JsonDocumentType& get() {return Doc_;}
+
+                void clear()
+                {
+                    // Memory pool allocators don't free values, so setting
+                    // to null is sufficient before clearing the arenas
+                    Doc_.SetNull();
+                    Allocator_.Clear();
+                    StackAllocator_.Clear();
+                }
+
+            private:
+
+                alignas(8) char Arena_[ARENA_SIZE];
+                alignas(8) char Stack_[STACK_SIZE];
+                rapidjson::MemoryPoolAllocator<> Allocator_;
+                rapidjson::MemoryPoolAllocator<> StackAllocator_;
+                JsonDocumentType Doc_;
+        };
+
+        // Returns the document to the pool when going out of scope
+        class Handle
+        {
+            public:
+
+                Handle(JsonDocumentPool* _Pool, std::unique_ptr<PooledDocument> _Doc) :
+                    Pool_(_Pool), Doc_(std::move(_Doc)) {}
+                Handle(Handle&& _h) noexcept : Pool_(_h.Pool_), Doc_(std::move(_h.Doc_)) {_h.Pool_ = nullptr;}
+                Handle(const Handle&) = delete;
+                Handle& operator=(const Handle&) = delete;
+                ~Handle() {if (Pool_ != nullptr && Doc_) Pool_->release(std::move(Doc_));}
+
+                JsonDocumentType& operator*() {return Doc_->get();}
+                JsonDocumentType* operator->() {return &Doc_->get();}
+
+            private:
+
+                JsonDocumentPool* Pool_{nullptr};
+                std::unique_ptr<PooledDocument> Doc_;
+        };
+
+        Handle acquire();
+
+        std::size_t getNumberOfDocuments() const {return NrOfDocuments_;}
+
+    private:
+
+        void release(std::unique_ptr<PooledDocument> _Doc);
+
+        std::vector<std::unique_ptr<PooledDocument>> Free_;
+        std::size_t NrOfDocuments_{0};
+
+};
+
+inline JsonDocumentPool::Handle JsonDocumentPool::acquire()
+{
+    if (Free_.empty())
+    {
+        ++NrOfDocuments_;
+        return Handle(this, std::make_unique<PooledDocument>());
+    }
+    auto Doc = std::move(Free_.back());
+    Free_.pop_back();
+    return Handle(this, std::move(Doc));
+}
+
+inline void JsonDocumentPool::release(std::unique_ptr<PooledDocument> _Doc)
+{
+    _Doc->clear();
+    Free_.push_back(std::move(_Doc));
+}
+
+#endif // JSON_DOCUMENT_POOL_HPP
@@ -0,0 +1,106 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// Log-linear histogram of durations in nanoseconds (HDR-like). Each power of
+// two is split into 16 linear sub-buckets, hence, the relative error is
+// below 6.25%. Values up to 2^40ns (~18min) are stored, larger values are
+// clamped.
+// Recording and reading are lock-free, so statistics might be read by any
+// thread while the owning thread records.
+class LatencyHistogram
+{
+
+    public:
+
+        static constexpr int SUB_BUCKET_BITS = 4;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int VALUE_BITS = 40;
+        static constexpr std::size_t BUCKETS = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        void record(double _Seconds) {this->recordNs(std::uint64_t(std::max(_Seconds, 0.0)*1.0e9));}
+        void recordNs(std::uint64_t _ns);
+        void reset();
+
+        std::uint64_t getCount() const {return Count_.load(std::memory_order_relaxed);}
+        double        getMax() const {return Max_.load(std::memory_order_relaxed)*1.0e-9;}
+        double        getSum() const {return Sum_.load(std::memory_order_relaxed)*1.0e-9;}
+        double        getPercentile(double _p) const;
+
+    private:
+
+        static std::size_t toBucket(std::uint64_t _ns);
+        static std::uint64_t toValue(std::size_t _b);
+
+        std::array<std::atomic<std::uint64_t>, BUCKETS> Buckets_{};
+        std::atomic<std::uint64_t> Count_{0};
+        std::atomic<std::uint64_t> Max_{0};
+        std::atomic<std::uint64_t> Sum_{0};
+
+};
+
+inline void LatencyHistogram::recordNs(std::uint64_t _ns)
+{
+    Buckets_[toBucket(_ns)].fetch_add(1, std::memory_order_relaxed);
+    Count_.fetch_add(1, std::memory_order_relaxed);
+    Sum_.fetch_add(_ns, std::memory_order_relaxed);
+
+    auto Max = Max_.load(std::memory_order_relaxed);
+    while (_ns > Max && !Max_.compare_exchange_weak(Max, _ns, std::memory_order_relaxed)) {}
+}
+
+inline void LatencyHistogram::reset()
+{
+    for (auto& b : Buckets_) b.store(0, std::memory_order_relaxed);
+    Count_.store(0, std::memory_order_relaxed);
+    Max_.store(0, std::memory_order_relaxed);
+    Sum_.store(0, std::memory_order_relaxed);
+}
+
+// Returns upper bound of the bucket containing the given percentile [0, 1],
+// in seconds
+inline double LatencyHistogram::getPercentile(double _p) const
+{
+    std::uint64_t Total{0};
+    for (const auto& b : Buckets_) Total += b.load(std::memory_order_relaxed);
+    if (Total == 0) return 0.0;
+
+    const auto Target = std::max(std::uint64_t(1), std::uint64_t(std::ceil(_p * double(Total))));
+    const auto Max = Max_.load(std::memory_order_relaxed);
+
+    std::uint64_t Sum{0};
+    for (auto i=0u; i<BUCKETS; ++i)
+    {
+        Sum += Buckets_[i].load(std::memory_order_relaxed);
+        if (Sum >= Target) return std::min(toValue(i), Max)*1.0e-9;
+    }
+    return Max*1.0e-9;
+}
+
+inline std::size_t LatencyHistogram::toBucket(std::uint64_t _ns)
+{
+    constexpr std::uint64_t VALUE_MAX = (std::uint64_t(1) << VALUE_BITS) - 1;
+
+    if (_ns < SUB_BUCKETS) return std::size_t(_ns);
+    if (_ns > VALUE_MAX) _ns = VALUE_MAX;
+
+    const int Msb = 63 - __builtin_clzll(_ns);
+    const int Shift = Msb - SUB_BUCKET_BITS;
+    return std::size_t(Shift + 1) * SUB_BUCKETS + std::size_t((_ns >> Shift) - SUB_BUCKETS);
+}
+
+inline std::uint64_t LatencyHistogram::toValue(std::size_t _b)
+{
+    if (_b < std::size_t(SUB_BUCKETS)) return _b;
+
+    const auto Shift = _b / SUB_BUCKETS - 1;
+    const auto Sub = _b % SUB_BUCKETS;
+    return ((SUB_BUCKETS + Sub + 1) << Shift) - 1;
+}
+
+#endif // LATENCY_HISTOGRAM_HPP
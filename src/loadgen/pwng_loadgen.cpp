@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <argagg/argagg.hpp>
+#include <rapidjson/document.h>
+
+#define ASIO_STANDALONE
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include "latency_histogram.hpp"
+#include "trace.hpp"
+
+// Headless load generator. Opens a number of websocket clients against a
+// running server, each following a configurable mix of subscriptions and
+// commands. Clients are added in stages, for each stage request latency,
+// notification inter-arrival times, throughput and the server's tick
+// statistics are reported. All clients are driven by a single asio thread,
+// hence, no locking is needed.
+
+using WsClientType = websocketpp::client<websocketpp::config::asio_client>;
+
+struct LoadMixType
+{
+    double DynamicData{1.0};    // Fraction of clients subscribing
+    double GalaxyData{0.0};
+    double PerfStats{0.0};      // First client always subscribes
+    double CommandRate{1.0};    // Commands per second and client
+    bool IsMutating{false};     // Commands change the simulation state
+};
+
+struct LoadClient
+{
+    websocketpp::connection_hdl Handle;
+    bool IsOpen{false};
+    std::uint32_t NextRequestID{1};
+    std::int64_t NextCommand{0};
+    std::unordered_map<std::uint32_t, std::pair<std::string, std::int64_t>> Pending; // ID -> method, time
+    std::unordered_map<std::string, std::int64_t> LastNotification; // Method and entity -> time
+};
+
+class LoadGenerator
+{
+
+    public:
+
+        LoadGenerator(const std::string& _Uri, const LoadMixType& _Mix) : Uri_(_Uri), Mix_(_Mix)
+        {
+            Endpoint_.clear_access_channels(websocketpp::log::alevel::all);
+            Endpoint_.clear_error_channels(websocketpp::log::elevel::all);
+            Endpoint_.init_asio();
+        }
+
+        bool run(std::size_t _Clients, std::size_t _Step, double _Duration, double _Warmup);
+
+    private:
+
+        using HistogramMap = std::map<std::string, std::unique_ptr<LatencyHistogram>>;
+
+        static LatencyHistogram& getHistogram(HistogramMap& _m, const std::string& _Name);
+
+        void connect(std::size_t _i);
+        void onMessage(std::size_t _i, WsClientType::message_ptr _Msg);
+        void onOpen(std::size_t _i);
+        void onTimer();
+
+        void printHeader() const;
+        void printStage(double _Elapsed) const;
+        void resetStats();
+        void send(std::size_t _i, const std::string& _Method, const std::string& _Params = "");
+        void startStage();
+
+        static constexpr long TIMER_PERIOD_MS = 10;
+
+        WsClientType Endpoint_;
+        std::string Uri_;
+        LoadMixType Mix_;
+        std::mt19937 Random_{42};
+
+        std::vector<LoadClient> Clients_;
+        std::size_t ClientsMax_{0};
+        std::size_t ClientsStep_{0};
+        double Duration_{10.0};
+        double Warmup_{2.0};
+
+        std::int64_t StageBegin_{0};
+        std::int64_t MeasureBegin_{0};
+        bool IsMeasuring_{false};
+        bool IsFailed_{false};
+
+        // Statistics of current stage
+        LatencyHistogram Latency_;      // All request methods
+        HistogramMap Latencies_;        // Per request method
+        HistogramMap InterArrivals_;    // Per notification method
+        std::uint64_t NumberOfRequests_{0};
+        std::uint64_t NumberOfResponses_{0};
+        std::uint64_t NumberOfErrors_{0};
+        std::uint64_t NumberOfNotifications_{0};
+        std::uint64_t NumberOfBytes_{0};
+        std::uint64_t Overruns_{0};
+        double TickP99Max_{0.0};
+
+};
+
+LatencyHistogram& LoadGenerator::getHistogram(HistogramMap& _m, const std::string& _Name)
+{
+    auto& h = _m[_Name];
+    if (!h) h = std::make_unique<LatencyHistogram>();
+    return *h;
+}
+
+bool LoadGenerator::run(std::size_t _Clients, std::size_t _Step, double _Duration, double _Warmup)
+{
+    ClientsMax_ = _Clients;
+    ClientsStep_ = std::max(std::size_t(1), std::min(_Step, _Clients));
+    Duration_ = _Duration;
+    Warmup_ = _Warmup;
+    Clients_.reserve(ClientsMax_);
+
+    this->printHeader();
+    this->startStage();
+    Endpoint_.set_timer(TIMER_PERIOD_MS, [this](const websocketpp::lib::error_code&){this->onTimer();});
+    Endpoint_.run();
+
+    return !IsFailed_;
+}
+
+void LoadGenerator::connect(std::size_t _i)
+{
+    websocketpp::lib::error_code ec;
+    auto Con = Endpoint_.get_connection(Uri_, ec);
+    if (ec)
+    {
+        std::cerr << "Couldn't create connection: " << ec.message() << std::endl;
+        IsFailed_ = true;
+        return;
+    }
+    Con->set_open_handler([this, _i](websocketpp::connection_hdl){this->onOpen(_i);});
+    Con->set_message_handler([this, _i](websocketpp::connection_hdl, WsClientType::message_ptr _Msg)
+                             {this->onMessage(_i, _Msg);});
+    Con->set_fail_handler([this, _i](websocketpp::connection_hdl)
+    {
+        std::cerr << "Connection of client " << _i << " failed" << std::endl;
+        IsFailed_ = true;
+    });
+    Con->set_close_handler([this, _i](websocketpp::connection_hdl){Clients_[_i].IsOpen = false;});
+
+    Clients_[_i].Handle = Con->get_handle();
+    Endpoint_.connect(Con);
+}
+
+void LoadGenerator::onMessage(std::size_t _i, WsClientType::message_ptr _Msg)
+{
+    const auto t = Tracer::now();
+    auto& c = Clients_[_i];
+
+    NumberOfBytes_ += _Msg->get_payload().size();
+
+    rapidjson::Document d;
+    d.Parse(_Msg->get_payload().c_str());
+    if (d.HasParseError() || !d.IsObject()) return;
+
+    if (d.HasMember("method") && d["method"].IsString())
+    {
+        ++NumberOfNotifications_;
+
+        std::string Key = d["method"].GetString();
+        const std::string Method = Key;
+        if (d.HasMember("params") && d["params"].IsObject())
+        {
+            const auto& p = d["params"];
+            if (p.HasMember("eid") && p["eid"].IsUint()) Key += ":" + std::to_string(p["eid"].GetUint());
+
+            // Tick statistics are taken from first client only
+            if (_i == 0 && Method == "perf_stats" && IsMeasuring_)
+            {
+                if (p.HasMember("t_tick_p99") && p["t_tick_p99"].IsNumber())
+                    TickP99Max_ = std::max(TickP99Max_, p["t_tick_p99"].GetDouble());
+                if (p.HasMember("n_overruns") && p["n_overruns"].IsUint64())
+                    Overruns_ += p["n_overruns"].GetUint64();
+            }
+        }
+
+        auto& Last = c.LastNotification[Key];
+        if (Last != 0 && IsMeasuring_) getHistogram(InterArrivals_, Method).recordNs(std::uint64_t(t - Last));
+        Last = t;
+    }
+    else if (d.HasMember("id") && d["id"].IsUint())
+    {
+        auto it = c.Pending.find(d["id"].GetUint());
+        if (it == c.Pending.end()) return;
+
+        if (d.HasMember("error")) ++NumberOfErrors_;
+        ++NumberOfResponses_;
+        if (IsMeasuring_)
+        {
+            const auto Latency = std::uint64_t(t - it->second.second);
+            getHistogram(Latencies_, it->second.first).recordNs(Latency);
+
+            // Galaxy data response follows the full galaxy, it is excluded
+            // from the summary
+            if (it->second.first != "sub_galaxy_data") Latency_.recordNs(Latency);
+        }
+        c.Pending.erase(it);
+    }
+}
+
+void LoadGenerator::onOpen(std::size_t _i)
+{
+    auto& c = Clients_[_i];
+    c.IsOpen = true;
+
+    std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+    if (Uniform(Random_) < Mix_.DynamicData) this->send(_i, "sub_dynamic_data");
+    if (Uniform(Random_) < Mix_.GalaxyData) this->send(_i, "sub_galaxy_data", "[\"evt\"]");
+    if (_i == 0 || Uniform(Random_) < Mix_.PerfStats) this->send(_i, "sub_perf_stats", "[\"s01\"]");
+
+    // Spread commands of clients over time
+    if (Mix_.CommandRate > 0.0)
+        c.NextCommand = Tracer::now() + std::int64_t(Uniform(Random_) * 1.0e9 / Mix_.CommandRate);
+}
+
+void LoadGenerator::onTimer()
+{
+    const auto t = Tracer::now();
+
+    if (IsFailed_)
+    {
+        Endpoint_.stop();
+        return;
+    }
+
+    // Commands due. By default, name queries answered by the main thread,
+    // which are read-only. Mutating commands pass the simulation thread,
+    // they (re)start the simulation and reset its acceleration.
+    if (Mix_.CommandRate > 0.0)
+    {
+        const auto Period = std::int64_t(1.0e9 / Mix_.CommandRate);
+        for (auto i=0u; i<Clients_.size(); ++i)
+        {
+            auto& c = Clients_[i];
+            if (!c.IsOpen || t < c.NextCommand) continue;
+            const bool IsEven = c.NextRequestID % 2 == 0;
+            if (Mix_.IsMutating)
+            {
+                if (IsEven)
+                    this->send(i, "cmd_start_simulation");
+                else
+                    this->send(i, "cmd_accelerate_simulation", "[1.0]");
+            }
+            else
+            {
+                if (IsEven)
+                    this->send(i, "cmd_find_name", "[\"Sun\"]");
+                else
+                    this->send(i, "cmd_search_name", "[\"Star_1\"]");
+            }
+            c.NextCommand += Period;
+        }
+    }
+
+    if (!IsMeasuring_ && t - StageBegin_ >= std::int64_t(Warmup_*1.0e9))
+    {
+        this->resetStats();
+        MeasureBegin_ = t;
+        IsMeasuring_ = true;
+    }
+    else if (IsMeasuring_ && t - MeasureBegin_ >= std::int64_t(Duration_*1.0e9))
+    {
+        this->printStage(double(t - MeasureBegin_)*1.0e-9);
+        if (Clients_.size() < ClientsMax_)
+        {
+            this->startStage();
+        }
+        else
+        {
+            websocketpp::lib::error_code ec;
+            for (auto& c : Clients_)
+            {
+                if (c.IsOpen) Endpoint_.close(c.Handle, websocketpp::close::status::going_away, "", ec);
+            }
+            return;
+        }
+    }
+
+    Endpoint_.set_timer(TIMER_PERIOD_MS, [this](const websocketpp::lib::error_code&){this->onTimer();});
+}
+
+void LoadGenerator::printHeader() const
+{
+    std::printf("%8s %10s %10s %10s %10s %10s %10s %10s %10s %8s\n",
+                "clients", "req/s", "msg/s", "MB/s", "lat_p50", "lat_p99", "lat_max",
+                "tick_p99", "overruns", "errors");
+}
+
+void LoadGenerator::printStage(double _Elapsed) const
+{
+    std::printf("%8zu %10.1f %10.1f %10.3f %8.3fms %8.3fms %8.3fms %8.3fms %10" PRIu64 " %8" PRIu64 "\n",
+                Clients_.size(),
+                NumberOfRequests_/_Elapsed, NumberOfNotifications_/_Elapsed,
+                NumberOfBytes_/_Elapsed*1.0e-6,
+                Latency_.getPercentile(0.5)*1.0e3, Latency_.getPercentile(0.99)*1.0e3, Latency_.getMax()*1.0e3,
+                TickP99Max_*1.0e3, Overruns_, NumberOfErrors_);
+
+    for (const auto& l : Latencies_)
+    {
+        std::printf("    latency       %-28s n=%-8" PRIu64 " p50=%8.3fms p99=%8.3fms p999=%8.3fms max=%8.3fms\n",
+                    l.first.c_str(), l.second->getCount(),
+                    l.second->getPercentile(0.5)*1.0e3, l.second->getPercentile(0.99)*1.0e3,
+                    l.second->getPercentile(0.999)*1.0e3, l.second->getMax()*1.0e3);
+    }
+    for (const auto& a : InterArrivals_)
+    {
+        const auto p50 = a.second->getPercentile(0.5);
+        const auto p99 = a.second->getPercentile(0.99);
+        std::printf("    interarrival  %-28s n=%-8" PRIu64 " p50=%8.3fms p99=%8.3fms max=%8.3fms jitter=%8.3fms\n",
+                    a.first.c_str(), a.second->getCount(), p50*1.0e3, p99*1.0e3,
+                    a.second->getMax()*1.0e3, (p99-p50)*1.0e3);
+    }
+    std::fflush(stdout);
+}
+
+void LoadGenerator::resetStats()
+{
+    Latency_.reset();
+    Latencies_.clear();
+    InterArrivals_.clear();
+    NumberOfRequests_ = 0;
+    NumberOfResponses_ = 0;
+    NumberOfErrors_ = 0;
+    NumberOfNotifications_ = 0;
+    NumberOfBytes_ = 0;
+    Overruns_ = 0;
+    TickP99Max_ = 0.0;
+}
+
+void LoadGenerator::send(std::size_t _i, const std::string& _Method, const std::string& _Params)
+{
+    auto& c = Clients_[_i];
+    const auto ID = c.NextRequestID++;
+
+    std::string Payload = "{\"jsonrpc\":\"2.0\",\"method\":\"" + _Method + "\"";
+    if (!_Params.empty()) Payload += ",\"params\":" + _Params;
+    Payload += ",\"id\":" + std::to_string(ID) + "}";
+
+    websocketpp::lib::error_code ec;
+    Endpoint_.send(c.Handle, Payload, websocketpp::frame::opcode::text, ec);
+    if (ec) return;
+
+    c.Pending[ID] = {_Method, Tracer::now()};
+    ++NumberOfRequests_;
+}
+
+void LoadGenerator::startStage()
+{
+    const auto Target = std::min(Clients_.size() + ClientsStep_, ClientsMax_);
+    while (Clients_.size() < Target)
+    {
+        Clients_.emplace_back();
+        this->connect(Clients_.size()-1);
+    }
+    StageBegin_ = Tracer::now();
+    IsMeasuring_ = false;
+}
+
+int main(int argc, char* argv[])
+{
+    argagg::parser ArgParser
+        {{
+            {"clients", {"-c", "--clients"},
+             "Maximum number of clients (default: 100)", 1},
+            {"command_rate", {"--command-rate"},
+             "Commands per second and client (default: 1.0)", 1},
+            {"duration", {"-t", "--duration"},
+             "Measurement time per stage in seconds (default: 10)", 1},
+            {"dynamic", {"--dynamic"},
+             "Fraction of clients subscribing to dynamic data (default: 1.0)", 1},
+            {"galaxy", {"--galaxy"},
+             "Fraction of clients subscribing to galaxy data events (default: 0.0)", 1},
+            {"help", {"-h", "--help"},
+             "Shows this help message", 0},
+            {"host", {"-H", "--host"},
+             "Server host (default: localhost)", 1},
+            {"mutating", {"--mutating"},
+             "Send commands changing the simulation state instead of read-only queries", 0},
+            {"perf", {"--perf"},
+             "Fraction of clients subscribing to performance stats (default: 0.0, first client always)", 1},
+            {"port", {"-p", "--port"},
+             "Server port (default: 9002)", 1},
+            {"step", {"-s", "--step"},
+             "Clients added per stage (default: all at once)", 1},
+            {"warmup", {"-w", "--warmup"},
+             "Time before measurement of each stage in seconds (default: 2)", 1}
+        }};
+
+    argagg::parser_results Args;
+    try
+    {
+        Args = ArgParser.parse(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Couldn't parse command line arguments, error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (Args["help"])
+    {
+        std::cout << "USAGE: \n\n" << ArgParser;
+        return EXIT_SUCCESS;
+    }
+
+    LoadMixType Mix;
+    Mix.CommandRate = Args["command_rate"].as<double>(Mix.CommandRate);
+    Mix.DynamicData = Args["dynamic"].as<double>(Mix.DynamicData);
+    Mix.GalaxyData = Args["galaxy"].as<double>(Mix.GalaxyData);
+    Mix.IsMutating = static_cast<bool>(Args["mutating"]);
+    Mix.PerfStats = Args["perf"].as<double>(Mix.PerfStats);
+
+    const auto Clients = Args["clients"].as<std::size_t>(100);
+    const auto Uri = "ws://" + Args["host"].as<std::string>("localhost") + ":" +
+                     std::to_string(Args["port"].as<int>(9002));
+
+    LoadGenerator Generator(Uri, Mix);
+    if (!Generator.run(Clients,
+                       Args["step"].as<std::size_t>(Clients),
+                       Args["duration"].as<double>(10.0),
+                       Args["warmup"].as<double>(2.0)))
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
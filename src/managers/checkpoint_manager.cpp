@@ -0,0 +1,193 @@
+#include "checkpoint_manager.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+#include <zlib.h>
+
+#include "message_handler.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+
+namespace
+{
+    constexpr char          MAGIC[8] = {'P', 'W', 'N', 'G', 'C', 'K', 'P', 'T'};
+    constexpr std::uint32_t VERSION = 8;
+
+    // Deflate doesn't compress by more than about 1032:1, larger sizes in the
+    // header of a checkpoint are corrupt
+    constexpr std::uint64_t COMPRESSION_RATIO_MAX = 1032;
+}
+
+CheckpointManager::~CheckpointManager()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        IsStopped_ = true;
+    }
+    Condition_.notify_one();
+    if (Thread_.joinable()) Thread_.join();
+}
+
+bool CheckpointManager::isDue(std::uint64_t _Tick, std::uint32_t _StepSize)
+{
+    if (!this->isEnabled()) return false;
+
+    if (IsRequested_.exchange(false, std::memory_order_relaxed)) return true;
+
+    const auto Period = std::uint64_t(Interval_ * 1000.0) / _StepSize;
+    return Period > 0 && _Tick > 0 && _Tick % Period == 0;
+}
+
+std::vector<char>* CheckpointManager::acquire()
+{
+    if (IsBusy_.load(std::memory_order_acquire))
+    {
+        Reg_.ctx<MessageHandler>().report("sim", "Previous checkpoint still being written, skipping",
+                                          MessageHandler::WARNING);
+        return nullptr;
+    }
+    // Capacity is kept, hence, there are no allocations after the first
+    // checkpoint unless the world grows
+    Buffer_.clear();
+    return &Buffer_;
+}
+
+void CheckpointManager::submit(std::uint64_t _Tick)
+{
+    IsBusy_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        Tick_ = _Tick;
+        IsSubmitted_ = true;
+    }
+    if (!Thread_.joinable()) Thread_ = std::thread(&CheckpointManager::run, this);
+    Condition_.notify_one();
+}
+
+void CheckpointManager::wait() const
+{
+    while (IsBusy_.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool CheckpointManager::load(std::vector<char>& _Data) const
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    std::FILE* File = std::fopen(RestoreFileName_.c_str(), "rb");
+    if (File == nullptr)
+    {
+        Messages.report("sim", "Couldn't open checkpoint "+RestoreFileName_);
+        return false;
+    }
+
+    char Magic[sizeof(MAGIC)];
+    std::uint32_t Version{0};
+    std::uint64_t Size{0};
+    bool IsValid = std::fread(Magic, sizeof(Magic), 1, File) == 1 &&
+                   std::memcmp(Magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                   std::fread(&Version, sizeof(Version), 1, File) == 1 && Version == VERSION &&
+                   std::fread(&Size, sizeof(Size), 1, File) == 1;
+
+    std::vector<char> Compressed;
+    if (IsValid)
+    {
+        char Chunk[65536];
+        std::size_t n{0};
+        while ((n = std::fread(Chunk, 1, sizeof(Chunk), File)) > 0)
+        {
+            Compressed.insert(Compressed.end(), Chunk, Chunk + n);
+        }
+    }
+    std::fclose(File);
+
+    // Size is read from the file, it's checked before allocating
+    IsValid = IsValid && Size <= Compressed.size() * COMPRESSION_RATIO_MAX &&
+              Size <= std::numeric_limits<uLongf>::max();
+    if (IsValid)
+    {
+        _Data.resize(Size);
+        uLongf SizeDecompressed = Size;
+        IsValid = uncompress(reinterpret_cast<Bytef*>(_Data.data()), &SizeDecompressed,
+                             reinterpret_cast<const Bytef*>(Compressed.data()), Compressed.size()) == Z_OK &&
+                  SizeDecompressed == Size;
+    }
+    if (!IsValid)
+    {
+        Messages.report("sim", "Invalid checkpoint "+RestoreFileName_);
+        return false;
+    }
+    return true;
+}
+
+void CheckpointManager::run()
+{
+    TRACE_THREAD("checkpoint");
+
+    while (true)
+    {
+        std::uint64_t Tick{0};
+        {
+            std::unique_lock<std::mutex> Lock(Lock_);
+            Condition_.wait(Lock, [this]{return IsSubmitted_ || IsStopped_;});
+            // Pending checkpoint is written before stopping
+            if (!IsSubmitted_) break;
+            IsSubmitted_ = false;
+            Tick = Tick_;
+        }
+        this->write(Tick);
+        IsBusy_.store(false, std::memory_order_release);
+    }
+}
+
+bool CheckpointManager::write(std::uint64_t _Tick)
+{
+    TRACE_ZONE("checkpoint_write");
+
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    Timer t;
+    t.start();
+
+    // Fast compression, checkpoints mostly consist of static galaxy data
+    uLongf SizeCompressed = compressBound(Buffer_.size());
+    Compressed_.resize(SizeCompressed);
+    if (compress2(reinterpret_cast<Bytef*>(Compressed_.data()), &SizeCompressed,
+                  reinterpret_cast<const Bytef*>(Buffer_.data()), Buffer_.size(), Z_BEST_SPEED) != Z_OK)
+    {
+        Messages.report("sim", "Couldn't compress checkpoint");
+        return false;
+    }
+
+    // Written to temporary file first, so a crash while writing doesn't
+    // destroy the previous checkpoint
+    const auto FileNameTmp = FileName_ + ".tmp";
+    std::FILE* File = std::fopen(FileNameTmp.c_str(), "wb");
+    if (File == nullptr)
+    {
+        Messages.report("sim", "Couldn't open checkpoint "+FileNameTmp);
+        return false;
+    }
+    const std::uint64_t Size = Buffer_.size();
+    bool IsWritten = std::fwrite(MAGIC, sizeof(MAGIC), 1, File) == 1 &&
+                     std::fwrite(&VERSION, sizeof(VERSION), 1, File) == 1 &&
+                     std::fwrite(&Size, sizeof(Size), 1, File) == 1 &&
+                     std::fwrite(Compressed_.data(), 1, SizeCompressed, File) == SizeCompressed;
+    IsWritten = (std::fclose(File) == 0) && IsWritten;
+
+    if (!IsWritten || std::rename(FileNameTmp.c_str(), FileName_.c_str()) != 0)
+    {
+        Messages.report("sim", "Couldn't write checkpoint "+FileName_);
+        return false;
+    }
+
+    t.stop();
+    Messages.report("sim", "Checkpoint of tick "+std::to_string(_Tick)+" written to "+FileName_+" ("+
+                    std::to_string(Size/1024)+"KiB -> "+std::to_string(SizeCompressed/1024)+"KiB, "+
+                    std::to_string(t.elapsed_ms())+"ms)", MessageHandler::INFO);
+    return true;
+}
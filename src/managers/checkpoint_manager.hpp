@@ -0,0 +1,203 @@
+#ifndef CHECKPOINT_MANAGER_HPP
+#define CHECKPOINT_MANAGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+#include "sim_components.hpp"
+
+// Binary archives for EnTT snapshots and additional simulation state. All
+// components are plain data and copied bytewise, except for star systems,
+// which hold a list of objects, and particle populations. Vectors of plain
+// data (e.g. columns of the star table) are copied as a whole.
+class CheckpointOutputArchive
+{
+
+    public:
+
+        explicit CheckpointOutputArchive(std::vector<char>& _Buffer) : Buffer_(_Buffer) {}
+
+        template<class T>
+        void operator()(const T& _v)
+        {
+            const auto* p = reinterpret_cast<const char*>(&_v);
+            Buffer_.insert(Buffer_.end(), p, p + sizeof(T));
+        }
+        void operator()(const StarSystemComponent& _s)
+        {
+            (*this)(std::uint32_t(_s.Objects.size()));
+            for (auto e : _s.Objects) (*this)(e);
+            (*this)(_s.Seed);
+        }
+        void operator()(const ParticlePopulationComponent& _p)
+        {
+            _p.Particles.save(*this);
+            (*this)(_p.CentralMass);
+            (*this)(_p.Lag);
+        }
+        template<class T>
+        void operator()(const std::vector<T>& _v)
+        {
+            (*this)(std::uint64_t(_v.size()));
+            const auto* p = reinterpret_cast<const char*>(_v.data());
+            Buffer_.insert(Buffer_.end(), p, p + _v.size()*sizeof(T));
+        }
+        template<class T>
+        void operator()(entt::entity _e, const T& _c)
+        {
+            (*this)(_e);
+            (*this)(_c);
+        }
+
+    private:
+
+        std::vector<char>& Buffer_;
+
+};
+
+class CheckpointInputArchive
+{
+
+    public:
+
+        explicit CheckpointInputArchive(const std::vector<char>& _Buffer) : Buffer_(_Buffer) {}
+
+        // False, if data was read beyond the end of the buffer
+        bool isValid() const {return IsValid_;}
+
+        template<class T>
+        void operator()(T& _v)
+        {
+            if (Pos_ + sizeof(T) > Buffer_.size())
+            {
+                IsValid_ = false;
+                _v = T{};
+                return;
+            }
+            std::memcpy(reinterpret_cast<char*>(&_v), Buffer_.data() + Pos_, sizeof(T));
+            Pos_ += sizeof(T);
+        }
+        void operator()(StarSystemComponent& _s)
+        {
+            std::uint32_t Size{0};
+            (*this)(Size);
+            _s.Objects.clear();
+            for (auto i=0u; i<Size && IsValid_; ++i)
+            {
+                entt::entity e{entt::null};
+                (*this)(e);
+                _s.Objects.push_back(e);
+            }
+            (*this)(_s.Seed);
+        }
+        void operator()(ParticlePopulationComponent& _p)
+        {
+            _p.Particles.load(*this);
+            (*this)(_p.CentralMass);
+            (*this)(_p.Lag);
+        }
+        template<class T>
+        void operator()(std::vector<T>& _v)
+        {
+            std::uint64_t Size{0};
+            (*this)(Size);
+            if (!IsValid_ || Size > (Buffer_.size() - Pos_) / sizeof(T))
+            {
+                IsValid_ = false;
+                _v.clear();
+                return;
+            }
+            _v.resize(Size);
+            std::memcpy(reinterpret_cast<char*>(_v.data()), Buffer_.data() + Pos_, Size*sizeof(T));
+            Pos_ += Size*sizeof(T);
+        }
+        template<class T>
+        void operator()(entt::entity& _e, T& _c)
+        {
+            (*this)(_e);
+            (*this)(_c);
+        }
+
+    private:
+
+        const std::vector<char>& Buffer_;
+        std::size_t Pos_{0};
+        bool IsValid_{true};
+
+};
+
+// Checkpoints of the simulation state. The simulation thread captures its
+// state into a buffer at a tick boundary (a plain copy), compression and
+// writing are done by a background thread. If that is still busy with the
+// previous checkpoint, capturing is skipped.
+//
+// File format: magic "PWNGCKPT", version (u32), size of uncompressed data
+// (u64), zlib compressed data.
+class CheckpointManager
+{
+
+    public:
+
+        explicit CheckpointManager(entt::registry& _Reg) : Reg_(_Reg) {}
+        ~CheckpointManager();
+        CheckpointManager(const CheckpointManager&) = delete;
+        CheckpointManager& operator=(const CheckpointManager&) = delete;
+
+        bool isEnabled() const {return !FileName_.empty();}
+        bool isRestoreRequested() const {return !RestoreFileName_.empty();}
+
+        void setFileName(const std::string& _FileName, double _Interval)
+        {
+            FileName_ = _FileName;
+            Interval_ = _Interval;
+        }
+        void setRestoreFileName(const std::string& _FileName) {RestoreFileName_ = _FileName;}
+
+        // Any thread, checkpoint is taken at next tick boundary
+        void request() {IsRequested_.store(true, std::memory_order_relaxed);}
+
+        // Simulation thread
+        bool isDue(std::uint64_t _Tick, std::uint32_t _StepSize);
+        std::vector<char>* acquire();
+        void submit(std::uint64_t _Tick);
+        void wait() const;
+
+        // Reads and decompresses checkpoint to restore from
+        bool load(std::vector<char>& _Data) const;
+
+    private:
+
+        void run();
+        bool write(std::uint64_t _Tick);
+
+        entt::registry& Reg_;
+
+        std::string FileName_;
+        std::string RestoreFileName_;
+        double      Interval_{0.0}; // Seconds, 0 disables periodic checkpoints
+
+        // Captured state, owned by writer thread while busy
+        std::vector<char> Buffer_;
+        std::vector<char> Compressed_;
+        std::uint64_t     Tick_{0};
+
+        std::atomic_bool IsBusy_{false};
+        std::atomic_bool IsRequested_{false};
+
+        std::mutex              Lock_;
+        std::condition_variable Condition_;
+        bool                    IsSubmitted_{false};
+        bool                    IsStopped_{false};
+        std::thread             Thread_;
+
+};
+
+#endif // CHECKPOINT_MANAGER_HPP
@@ -0,0 +1,40 @@
+#include "galactic_field_manager.hpp"
+
+#include <string>
+
+#include "message_handler.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+
+GalacticFieldManager::~GalacticFieldManager()
+{
+    if (Thread_.joinable()) Thread_.join();
+}
+
+void GalacticFieldManager::build(const StarTable& _Stars)
+{
+    if (Thread_.joinable()) Thread_.join();
+
+    // Field is only read after joining, hence, no race
+    Thread_ = std::thread(
+        [this, Stars = _Stars]
+        {
+            TRACE_THREAD("galactic_field");
+            TRACE_ZONE("galactic_field_build");
+
+            Timer t;
+            t.start();
+            Field_ = std::make_shared<const GalacticField>(Stars);
+            t.stop();
+
+            Reg_.ctx<MessageHandler>().report("sim", "Galactic field built ("+
+                                              std::to_string(Field_->getNumberOfMassNodes())+" nodes, "+
+                                              std::to_string(t.elapsed_ms())+"ms)", MessageHandler::INFO);
+        });
+}
+
+std::shared_ptr<const GalacticField> GalacticFieldManager::wait()
+{
+    if (Thread_.joinable()) Thread_.join();
+    return Field_;
+}
@@ -0,0 +1,41 @@
+#ifndef GALACTIC_FIELD_MANAGER_HPP
+#define GALACTIC_FIELD_MANAGER_HPP
+
+#include <memory>
+#include <thread>
+
+#include <entt/entity/registry.hpp>
+
+#include "galactic_field.hpp"
+#include "star_table.hpp"
+
+// Builds the galactic field in the background, while the simulation builds
+// the density pyramid and name index. The galaxy is static after
+// generation, hence, the field is built once and waited for before the
+// rotation curve is derived from it, see GalacticRotation.
+class GalacticFieldManager
+{
+
+    public:
+
+        explicit GalacticFieldManager(entt::registry& _Reg) : Reg_(_Reg) {}
+        ~GalacticFieldManager();
+        GalacticFieldManager(const GalacticFieldManager&) = delete;
+        GalacticFieldManager& operator=(const GalacticFieldManager&) = delete;
+
+        // Simulation thread, table is copied
+        void build(const StarTable& _Stars);
+
+        // Simulation thread, blocks until the field is built
+        std::shared_ptr<const GalacticField> wait();
+
+    private:
+
+        entt::registry& Reg_;
+
+        std::shared_ptr<const GalacticField> Field_;
+        std::thread Thread_;
+
+};
+
+#endif // GALACTIC_FIELD_MANAGER_HPP
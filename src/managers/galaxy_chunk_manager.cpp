@@ -0,0 +1,87 @@
+#include "galaxy_chunk_manager.hpp"
+
+#include <vector>
+
+#include "binary_frame.hpp"
+#include "message_handler.hpp"
+#include "metrics_manager.hpp"
+#include "trace.hpp"
+
+namespace
+{
+    constexpr char GALAXY_CHUNK_FRAME_MAGIC[4] = {'P', 'W', 'G', 'C'};
+}
+
+void GalaxyChunkManager::init(std::uint32_t _Seed, const GalacticRotation& _Rotation)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    Galaxy_ = std::make_unique<ProceduralGalaxy>(_Seed);
+    Rotation_ = _Rotation;
+    Chunks_.clear();
+    Index_.clear();
+    NumberOfStars_ = 0;
+
+    Messages.report("prg", "Procedural galaxy chunks initialised with seed "+std::to_string(_Seed), MessageHandler::INFO);
+}
+
+std::shared_ptr<const GalaxyChunk> GalaxyChunkManager::get(std::int32_t _x, std::int32_t _y)
+{
+    const auto Key = toKey(_x, _y);
+    auto it = Index_.find(Key);
+    if (it != Index_.end())
+    {
+        Chunks_.splice(Chunks_.begin(), Chunks_, it->second);
+        return Chunks_.front();
+    }
+
+    TRACE_ZONE("galaxy_chunk_generate");
+
+    auto Chunk = std::make_shared<GalaxyChunk>();
+    Chunk->X = _x;
+    Chunk->Y = _y;
+    Galaxy_->generateChunk(_x, _y, Chunk->Stars);
+
+    Chunks_.push_front(Chunk);
+    Index_.emplace(Key, Chunks_.begin());
+    NumberOfStars_ += Chunk->Stars.size();
+
+    // The queried chunk is never evicted
+    while (Chunks_.size() > 1 &&
+           (Chunks_.size() > GALAXY_CHUNKS_CACHED_MAX || NumberOfStars_ > GALAXY_CHUNK_STARS_CACHED_MAX))
+    {
+        const auto& Cold = *Chunks_.back();
+        NumberOfStars_ -= Cold.Stars.size();
+        Index_.erase(toKey(Cold.X, Cold.Y));
+        Chunks_.pop_back();
+    }
+
+    Reg_.ctx<MetricsManager>().setGalaxyChunkCounts(Index_.size(), NumberOfStars_);
+    return Chunk;
+}
+
+std::string GalaxyChunkManager::getFrame(const GalaxyChunk& _Chunk, std::uint32_t _RequestID, double _t) const
+{
+    const auto& s = _Chunk.Stars;
+    const auto n = std::uint32_t(s.size());
+
+    std::vector<double> X(n);
+    std::vector<double> Y(n);
+    Rotation_.getPositions(n, s.getXs(), s.getYs(), _t, X.data(), Y.data());
+
+    std::string Frame;
+    Frame.reserve(4 + 4*sizeof(std::uint32_t) + sizeof(double) + std::size_t(n)*(2*sizeof(double) + 3*sizeof(float) + 1));
+    Frame.append(GALAXY_CHUNK_FRAME_MAGIC, sizeof(GALAXY_CHUNK_FRAME_MAGIC));
+    appendBinary(Frame, _RequestID);
+    appendBinary(Frame, _Chunk.X);
+    appendBinary(Frame, _Chunk.Y);
+    appendBinary(Frame, n);
+    appendBinary(Frame, GALAXY_CHUNK_SIZE);
+    Frame.append(reinterpret_cast<const char*>(X.data()), n*sizeof(double));
+    Frame.append(reinterpret_cast<const char*>(Y.data()), n*sizeof(double));
+    for (auto i=0u; i<n; ++i) appendBinary(Frame, s.getMass(i));
+    for (auto i=0u; i<n; ++i) appendBinary(Frame, s.getRadius(i));
+    for (auto i=0u; i<n; ++i) appendBinary(Frame, s.getTemperature(i));
+    for (auto i=0u; i<n; ++i) appendBinary(Frame, std::uint8_t(s.getSpectralClass(i)));
+    return Frame;
+}
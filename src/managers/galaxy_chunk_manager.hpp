@@ -0,0 +1,83 @@
+#ifndef GALAXY_CHUNK_MANAGER_HPP
+#define GALAXY_CHUNK_MANAGER_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <entt/entity/registry.hpp>
+
+#include "galactic_rotation.hpp"
+#include "procedural_galaxy.hpp"
+#include "star_table.hpp"
+
+// Limits of the chunk cache, whatever is reached first
+constexpr std::size_t GALAXY_CHUNKS_CACHED_MAX = 65536;
+constexpr std::size_t GALAXY_CHUNK_STARS_CACHED_MAX = 4000000;
+
+struct GalaxyChunk
+{
+    std::int32_t X{0};
+    std::int32_t Y{0};
+    StarTable    Stars;
+};
+
+// Chunks of the procedural galaxy, generated when queried and kept in an
+// LRU cache. Cold chunks are dropped once the cache exceeds its limits and
+// regenerated when queried again, which gives the same stars. Hence, the
+// galaxy is effectively unbounded, memory only depends on the active area.
+// Chunks are shared read-only, holders keep evicted chunks alive. They
+// contain the stars that were in the chunk at t = 0, frames give their
+// positions at the requested time.
+// Used by the broker (main thread) only.
+//
+// Frame format (little endian):
+//   magic "PWGC", request ID (u32), chunk x, y (i32), number of stars n
+//   (u32), chunk size (f64, m), columns of n values each: x, y (f64, m,
+//   at current simulation time),
+//   mass (f32, kg), radius (f32, m), temperature (f32, K), spectral class
+//   (u8, 0-6 = M-O)
+class GalaxyChunkManager
+{
+
+    public:
+
+        explicit GalaxyChunkManager(entt::registry& _Reg) : Reg_(_Reg) {}
+        GalaxyChunkManager(const GalaxyChunkManager&) = delete;
+        GalaxyChunkManager& operator=(const GalaxyChunkManager&) = delete;
+
+        // Chunks rotate like the simulated galaxy
+        void init(std::uint32_t _Seed, const GalacticRotation& _Rotation);
+        bool isInitialised() const {return Galaxy_ != nullptr;}
+
+        std::shared_ptr<const GalaxyChunk> get(std::int32_t _x, std::int32_t _y);
+
+        std::size_t getNumberOfChunks() const {return Index_.size();}
+        std::size_t getNumberOfStars() const {return NumberOfStars_;}
+
+        // Positions are evaluated at time _t (s), see GalacticRotation
+        std::string getFrame(const GalaxyChunk& _Chunk, std::uint32_t _RequestID, double _t) const;
+
+    private:
+
+        static std::uint64_t toKey(std::int32_t _x, std::int32_t _y)
+        {
+            return (std::uint64_t(std::uint32_t(_x)) << 32) | std::uint32_t(_y);
+        }
+
+        entt::registry& Reg_;
+
+        std::unique_ptr<ProceduralGalaxy> Galaxy_;
+        GalacticRotation Rotation_;
+
+        // Most recently used first
+        using ChunkList = std::list<std::shared_ptr<const GalaxyChunk>>;
+        ChunkList Chunks_;
+        std::unordered_map<std::uint64_t, ChunkList::iterator> Index_;
+        std::size_t NumberOfStars_{0};
+
+};
+
+#endif // GALAXY_CHUNK_MANAGER_HPP
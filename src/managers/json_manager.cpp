@@ -238,15 +238,15 @@ void JsonManager::finalise(RequestIDType _ReqID)
     HasParams_ = false;
 }
 
-JsonManager::ParamCheckResult JsonManager::checkParams(std::shared_ptr<const rapidjson::Document> _d, std::vector<ParamsType> _p)
+JsonManager::ParamCheckResult JsonManager::checkParams(const rapidjson::Value& _v, const std::vector<ParamsType>& _p)
 {
     ParamCheckResult ReturnValue;
 
     auto& Messages = Reg_.ctx<MessageHandler>();
 
-    if (_d->HasMember("params"))
+    if (_v.HasMember("params") && _v["params"].IsArray())
     {
-        const auto& ParamsArray = (*_d)["params"].GetArray();
+        const auto& ParamsArray = _v["params"].GetArray();
         if (ParamsArray.Size() == _p.size())
         {
             for (auto i=0u; i < ParamsArray.Size(); ++i)
@@ -272,17 +272,17 @@ JsonManager::ParamCheckResult JsonManager::checkParams(std::shared_ptr<const rap
                 if (!ParamTypeOkay)
                 {
                     Messages.report("jsn", "Wrong parameter type.", MessageHandler::WARNING);
-                    ReturnValue = {false, ErrorType::PARAMS, (*_d)["id"].GetUint(),
+                    ReturnValue = {false, ErrorType::PARAMS, _v["id"].GetUint(),
                                    "Wrong type for parameter "+std::to_string(i+1)};
                 }
             }
         }
         else
         {
-            Messages.report("jsn", "Wrong number of parameters: "+
-                            std::to_string(ParamsArray.Size())+" of "+
-                            std::to_string(_p.size()), MessageHandler::WARNING);
-            ReturnValue = {false, ErrorType::PARAMS, (*_d)["id"].GetUint(),
+            MSG_REPORT(Messages, "jsn", "Wrong number of parameters: "+
+                                 std::to_string(ParamsArray.Size())+" of "+
+                                 std::to_string(_p.size()), MessageHandler::WARNING);
+            ReturnValue = {false, ErrorType::PARAMS, _v["id"].GetUint(),
                            "Wrong number of parameters, "+
                            std::to_string(ParamsArray.Size())+" of "+
                            std::to_string(_p.size())};
@@ -294,9 +294,9 @@ JsonManager::ParamCheckResult JsonManager::checkParams(std::shared_ptr<const rap
         if (_p.size() > 0)
         {
             r = false;
-            Messages.report("jsn", "Parameter member missing: 0 of " + std::to_string(_p.size()) + " parameters.", MessageHandler::WARNING);
+            MSG_REPORT(Messages, "jsn", "Parameter member missing: 0 of " + std::to_string(_p.size()) + " parameters.", MessageHandler::WARNING);
         }
-        ReturnValue = {r, ErrorType::PARAMS, (*_d)["id"].GetUint()};
+        ReturnValue = {r, ErrorType::PARAMS, _v["id"].GetUint()};
     }
 
     return ReturnValue;
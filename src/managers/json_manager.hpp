@@ -87,6 +87,7 @@ class JsonManager
         // Add a key-value pair
         JsonManager& addNamedValue(const char* _n, bool _v);
         JsonManager& addNamedValue(const char* _n, const char* _v);
+        JsonManager& addNamedValue(const char* _n, std::uint32_t _v);
 
         // Add a singular value, mainly in arrays
         JsonManager& addValue(double _v);
@@ -101,17 +102,15 @@ class JsonManager
         // Helper functions to
         // * check for JSON-RPC keys
         // * get JSON-RPC specific values
-        // * replace JSON-RPC values in document
 
-        ParamCheckResult checkParams(std::shared_ptr<const rapidjson::Document> _d, std::vector<ParamsType> _p);
+        ParamCheckResult checkParams(const rapidjson::Value& _v, const std::vector<ParamsType>& _p);
 
-        static bool checkID(std::shared_ptr<const rapidjson::Document> _d);
-        static bool checkMethod(std::shared_ptr<const rapidjson::Document> _d);
-        static bool checkRequest(std::shared_ptr<const rapidjson::Document> _d);
-        static auto getID(std::shared_ptr<const rapidjson::Document> _d);
-        static auto getMethod(std::shared_ptr<const rapidjson::Document> _d);
-        static auto getParams(std::shared_ptr<const rapidjson::Document> _d);
-        static void replaceMethod(std::shared_ptr<rapidjson::Document> _d, const char* _s);
+        static bool checkID(const rapidjson::Value& _v);
+        static bool checkMethod(const rapidjson::Value& _v);
+        static bool checkRequest(const rapidjson::Value& _v);
+        static auto getID(const rapidjson::Value& _v);
+        static auto getMethod(const rapidjson::Value& _v);
+        static auto getParams(const rapidjson::Value& _v);
 
     private:
 
@@ -174,41 +173,46 @@ inline JsonManager& JsonManager::addNamedValue(const char* _n, const char* _v)
     return *this;
 }
 
-inline bool JsonManager::checkID(std::shared_ptr<const rapidjson::Document> _d)
+inline JsonManager& JsonManager::addNamedValue(const char* _n, std::uint32_t _v)
 {
-    if (_d->HasMember("id")) return true;
-    else return false;
+    DBLK(this->checkCreate();)
+
+    Writer_.Key(_n);
+    Writer_.Uint(_v);
+
+    return *this;
 }
 
-inline bool JsonManager::checkMethod(std::shared_ptr<const rapidjson::Document> _d)
+inline bool JsonManager::checkID(const rapidjson::Value& _v)
 {
-    if (_d->HasMember("method")) return true;
+    if (_v.IsObject() && _v.HasMember("id") && _v["id"].IsUint()) return true;
     else return false;
 }
 
-inline bool JsonManager::checkRequest(std::shared_ptr<const rapidjson::Document> _d)
+inline bool JsonManager::checkMethod(const rapidjson::Value& _v)
 {
-    return (JsonManager::checkMethod(_d) & JsonManager::checkID(_d));
+    if (_v.IsObject() && _v.HasMember("method") && _v["method"].IsString()) return true;
+    else return false;
 }
 
-inline auto JsonManager::getID(std::shared_ptr<const rapidjson::Document> _d)
+inline bool JsonManager::checkRequest(const rapidjson::Value& _v)
 {
-    return (*_d)["id"].GetUint();
+    return (JsonManager::checkMethod(_v) & JsonManager::checkID(_v));
 }
 
-inline auto JsonManager::getMethod(std::shared_ptr<const rapidjson::Document> _d)
+inline auto JsonManager::getID(const rapidjson::Value& _v)
 {
-    return (*_d)["method"].GetString();
+    return _v["id"].GetUint();
 }
 
-inline auto JsonManager::getParams(std::shared_ptr<const rapidjson::Document> _d)
+inline auto JsonManager::getMethod(const rapidjson::Value& _v)
 {
-    return (*_d)["params"].GetArray();
+    return _v["method"].GetString();
 }
 
-inline void JsonManager::replaceMethod(std::shared_ptr<rapidjson::Document> _d, const char* _s)
+inline auto JsonManager::getParams(const rapidjson::Value& _v)
 {
-    (*_d)["method"].SetString(_s, _d->GetAllocator());
+    return _v["params"].GetArray();
 }
 
 #endif // JSON_MANAGER_HPP
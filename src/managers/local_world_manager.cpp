@@ -0,0 +1,52 @@
+#include "local_world_manager.hpp"
+
+#include <algorithm>
+
+#include "sim_components.hpp"
+#include "trace.hpp"
+
+b2World* LocalWorldManager::create(entt::entity _Parent, const b2Vec2& _Gravity)
+{
+    Reg_.emplace_or_replace<LocalWorldComponent>(_Parent, std::uint32_t(Worlds_.size()));
+
+    auto& w = Worlds_.emplace_back();
+    w.World = std::make_unique<b2World>(_Gravity);
+    w.Parent = _Parent;
+    Awake_.push_back(Worlds_.size()-1);
+
+    return w.World.get();
+}
+
+b2World* LocalWorldManager::get(entt::entity _Parent) const
+{
+    const auto* l = Reg_.try_get<LocalWorldComponent>(_Parent);
+    return l != nullptr ? Worlds_[l->Index].World.get() : nullptr;
+}
+
+void LocalWorldManager::step(float _Seconds, JobPool& _Jobs)
+{
+    // Worlds are independent, each job steps one world and checks, if
+    // there is anything left to simulate
+    _Jobs.parallelFor(Awake_.size(),
+        [this, _Seconds](std::size_t i)
+        {
+            TRACE_ZONE("box2d_local_world");
+
+            auto& w = Worlds_[Awake_[i]];
+            w.World->Step(_Seconds, 8, 3);
+
+            w.IsAwake = false;
+            for (const auto* b = w.World->GetBodyList(); b != nullptr; b = b->GetNext())
+            {
+                if (b->GetType() != b2_staticBody && b->IsAwake())
+                {
+                    w.IsAwake = true;
+                    break;
+                }
+            }
+        });
+
+    Awake_.erase(std::remove_if(Awake_.begin(), Awake_.end(),
+                                [this](auto i){return !Worlds_[i].IsAwake;}),
+                 Awake_.end());
+}
@@ -0,0 +1,60 @@
+#ifndef LOCAL_WORLD_MANAGER_HPP
+#define LOCAL_WORLD_MANAGER_HPP
+
+#include <memory>
+#include <vector>
+
+#include <box2d/box2d.h>
+#include <entt/entity/registry.hpp>
+
+#include "job_pool.hpp"
+
+// Owns the local box2d worlds, each attached to a parent body or region
+// entity via LocalWorldComponent. Only awake worlds are stepped, in
+// parallel. A world falls asleep when none of its bodies is awake anymore.
+// Nothing acts on local bodies from outside of their world, hence, a world
+// that fell asleep stays asleep. Only the list of awake worlds is walked
+// when stepping, so the number of sleeping worlds doesn't matter.
+class LocalWorldManager
+{
+
+    public:
+
+        explicit LocalWorldManager(entt::registry& _Reg) : Reg_(_Reg) {}
+        LocalWorldManager(const LocalWorldManager&) = delete;
+        LocalWorldManager& operator=(const LocalWorldManager&) = delete;
+
+        b2World* create(entt::entity _Parent, const b2Vec2& _Gravity);
+        b2World* get(entt::entity _Parent) const;
+
+        std::size_t getNumberOfWorlds() const {return Worlds_.size();}
+        std::size_t getNumberOfAwakeWorlds() const {return Awake_.size();}
+
+        // Worlds in creation order, which is the same after recreation
+        template<class F> void each(F _f)
+        {
+            for (auto& w : Worlds_) _f(w.Parent, *w.World);
+        }
+        template<class F> void each(F _f) const
+        {
+            for (const auto& w : Worlds_) _f(w.Parent, static_cast<const b2World&>(*w.World));
+        }
+
+        void step(float _Seconds, JobPool& _Jobs);
+
+    private:
+
+        struct LocalWorld
+        {
+            std::unique_ptr<b2World> World;
+            entt::entity Parent{entt::null};
+            bool IsAwake{true};
+        };
+
+        entt::registry& Reg_;
+
+        std::vector<LocalWorld>  Worlds_;
+        std::vector<std::size_t> Awake_;
+};
+
+#endif // LOCAL_WORLD_MANAGER_HPP
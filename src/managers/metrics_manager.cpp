@@ -0,0 +1,106 @@
+#include "metrics_manager.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    std::string toText(double _v)
+    {
+        char Buffer[32];
+        std::snprintf(Buffer, sizeof(Buffer), "%.9g", _v);
+        return Buffer;
+    }
+
+    void addHeader(std::string& _s, const char* _Name, const char* _Type, const char* _Help)
+    {
+        _s += std::string("# HELP ") + _Name + " " + _Help + "\n";
+        _s += std::string("# TYPE ") + _Name + " " + _Type + "\n";
+    }
+}
+
+void MetricsManager::init(const moodycamel::ConcurrentQueue<NetworkMessage>* const _InputQueue,
+                          const moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue,
+                          const moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueSimIn,
+                          const TickStats* const _Stats)
+{
+    InputQueue_ = _InputQueue;
+    OutputQueue_ = _OutputQueue;
+    QueueSimIn_ = _QueueSimIn;
+    Stats_ = _Stats;
+}
+
+std::string MetricsManager::getText() const
+{
+    std::string s;
+    s.reserve(8192);
+
+    //--- Tick phases ---//
+    if (Stats_ != nullptr)
+    {
+        addHeader(s, "pwng_tick_phase_seconds", "summary", "Duration of simulation tick phases since start or reset");
+        for (auto i=0u; i<std::size_t(TickPhaseType::COUNT); ++i)
+        {
+            const auto& h = Stats_->get(TickStatsWindowType::TOTAL, TickPhaseType(i));
+            // Strip "t_" prefix of perf_stats names
+            const std::string Phase = std::string("{phase=\"") + (TICK_PHASE_NAMES[i]+2) + "\"";
+            s += "pwng_tick_phase_seconds" + Phase + ",quantile=\"0.5\"} " + toText(h.getPercentile(0.5)) + "\n";
+            s += "pwng_tick_phase_seconds" + Phase + ",quantile=\"0.99\"} " + toText(h.getPercentile(0.99)) + "\n";
+            s += "pwng_tick_phase_seconds" + Phase + ",quantile=\"0.999\"} " + toText(h.getPercentile(0.999)) + "\n";
+            s += "pwng_tick_phase_seconds" + Phase + ",quantile=\"1\"} " + toText(h.getMax()) + "\n";
+            s += "pwng_tick_phase_seconds_sum" + Phase + "} " + toText(h.getSum()) + "\n";
+            s += "pwng_tick_phase_seconds_count" + Phase + "} " + std::to_string(h.getCount()) + "\n";
+        }
+        addHeader(s, "pwng_tick_overruns_total", "counter", "Ticks exceeding step time since start or reset");
+        s += "pwng_tick_overruns_total " + std::to_string(Stats_->getOverruns(TickStatsWindowType::TOTAL)) + "\n";
+    }
+
+    //--- Queues ---//
+    addHeader(s, "pwng_queue_depth", "gauge", "Approximate number of queued items");
+    if (InputQueue_ != nullptr)
+        s += "pwng_queue_depth{queue=\"input\"} " + std::to_string(InputQueue_->size_approx()) + "\n";
+    if (QueueSimIn_ != nullptr)
+        s += "pwng_queue_depth{queue=\"sim_in\"} " + std::to_string(QueueSimIn_->size_approx()) + "\n";
+    if (OutputQueue_ != nullptr)
+        s += "pwng_queue_depth{queue=\"output\"} " + std::to_string(OutputQueue_->size_approx()) + "\n";
+
+    //--- Network ---//
+    addHeader(s, "pwng_connections", "gauge", "Open websocket connections");
+    s += "pwng_connections " + std::to_string(Connections_.load(std::memory_order_relaxed)) + "\n";
+
+    addHeader(s, "pwng_received_messages_total", "counter", "Received websocket messages");
+    s += "pwng_received_messages_total " + std::to_string(ReceivedMessages_.load(std::memory_order_relaxed)) + "\n";
+    addHeader(s, "pwng_received_bytes_total", "counter", "Received websocket payload bytes");
+    s += "pwng_received_bytes_total " + std::to_string(ReceivedBytes_.load(std::memory_order_relaxed)) + "\n";
+
+    addHeader(s, "pwng_sent_messages_total", "counter", "Sent websocket messages by topic");
+    for (auto i=0u; i<std::size_t(NetworkTopicType::COUNT); ++i)
+    {
+        s += std::string("pwng_sent_messages_total{topic=\"") + NETWORK_TOPIC_NAMES[i] + "\"} " +
+             std::to_string(SentMessages_[i].load(std::memory_order_relaxed)) + "\n";
+    }
+    addHeader(s, "pwng_sent_bytes_total", "counter", "Sent websocket payload bytes by topic");
+    for (auto i=0u; i<std::size_t(NetworkTopicType::COUNT); ++i)
+    {
+        s += std::string("pwng_sent_bytes_total{topic=\"") + NETWORK_TOPIC_NAMES[i] + "\"} " +
+             std::to_string(SentBytes_[i].load(std::memory_order_relaxed)) + "\n";
+    }
+
+    //--- Simulation ---//
+    addHeader(s, "pwng_entities", "gauge", "Number of entities by kind");
+    s += "pwng_entities{kind=\"world\"} " + std::to_string(Entities_.load(std::memory_order_relaxed)) + "\n";
+    s += "pwng_entities{kind=\"star\"} " + std::to_string(Stars_.load(std::memory_order_relaxed)) + "\n";
+    s += "pwng_entities{kind=\"star_system\"} " + std::to_string(Systems_.load(std::memory_order_relaxed)) + "\n";
+    s += "pwng_entities{kind=\"client\"} " + std::to_string(Clients_.load(std::memory_order_relaxed)) + "\n";
+
+    addHeader(s, "pwng_local_worlds", "gauge", "Number of local box2d worlds by state");
+    s += "pwng_local_worlds{state=\"awake\"} " + std::to_string(LocalWorldsAwake_.load(std::memory_order_relaxed)) + "\n";
+    s += "pwng_local_worlds{state=\"asleep\"} " +
+         std::to_string(LocalWorlds_.load(std::memory_order_relaxed) - LocalWorldsAwake_.load(std::memory_order_relaxed)) + "\n";
+
+    addHeader(s, "pwng_galaxy_chunks", "gauge", "Number of cached chunks of the procedural galaxy");
+    s += "pwng_galaxy_chunks " + std::to_string(GalaxyChunks_.load(std::memory_order_relaxed)) + "\n";
+    addHeader(s, "pwng_galaxy_chunk_stars", "gauge", "Number of stars in cached chunks of the procedural galaxy");
+    s += "pwng_galaxy_chunk_stars " + std::to_string(GalaxyChunkStars_.load(std::memory_order_relaxed)) + "\n";
+
+    return s;
+}
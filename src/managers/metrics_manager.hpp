@@ -0,0 +1,94 @@
+#ifndef METRICS_MANAGER_HPP
+#define METRICS_MANAGER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <concurrentqueue/concurrentqueue.h>
+#include <entt/entity/registry.hpp>
+
+#include "network_command.hpp"
+#include "network_message.hpp"
+#include "tick_stats.hpp"
+
+// Collects server metrics and provides them in Prometheus text format. All
+// values are published atomically by the threads owning them, so scraping
+// (from the network thread) never touches the simulation thread.
+class MetricsManager
+{
+
+    public:
+
+        explicit MetricsManager(entt::registry& _Reg) : Reg_(_Reg) {}
+
+        void init(const moodycamel::ConcurrentQueue<NetworkMessage>* const _InputQueue,
+                  const moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue,
+                  const moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueSimIn,
+                  const TickStats* const _Stats);
+
+        // Network threads
+        void countReceived(std::size_t _Bytes)
+        {
+            ReceivedMessages_.fetch_add(1, std::memory_order_relaxed);
+            ReceivedBytes_.fetch_add(_Bytes, std::memory_order_relaxed);
+        }
+        void countSent(NetworkTopicType _t, std::size_t _Bytes)
+        {
+            SentMessages_[std::size_t(_t)].fetch_add(1, std::memory_order_relaxed);
+            SentBytes_[std::size_t(_t)].fetch_add(_Bytes, std::memory_order_relaxed);
+        }
+        void setConnections(std::size_t _n) {Connections_.store(_n, std::memory_order_relaxed);}
+
+        // Simulation thread, published each tick
+        void setEntityCounts(std::size_t _Entities, std::size_t _Stars, std::size_t _Systems, std::size_t _Clients)
+        {
+            Entities_.store(_Entities, std::memory_order_relaxed);
+            Stars_.store(_Stars, std::memory_order_relaxed);
+            Systems_.store(_Systems, std::memory_order_relaxed);
+            Clients_.store(_Clients, std::memory_order_relaxed);
+        }
+
+        void setLocalWorldCounts(std::size_t _Worlds, std::size_t _Awake)
+        {
+            LocalWorlds_.store(_Worlds, std::memory_order_relaxed);
+            LocalWorldsAwake_.store(_Awake, std::memory_order_relaxed);
+        }
+
+        // Main thread
+        void setGalaxyChunkCounts(std::size_t _Chunks, std::size_t _Stars)
+        {
+            GalaxyChunks_.store(_Chunks, std::memory_order_relaxed);
+            GalaxyChunkStars_.store(_Stars, std::memory_order_relaxed);
+        }
+
+        std::string getText() const;
+
+    private:
+
+        entt::registry& Reg_;
+
+        const moodycamel::ConcurrentQueue<NetworkMessage>* InputQueue_{nullptr};
+        const moodycamel::ConcurrentQueue<NetworkMessage>* OutputQueue_{nullptr};
+        const moodycamel::ConcurrentQueue<NetworkCommand>* QueueSimIn_{nullptr};
+        const TickStats* Stats_{nullptr};
+
+        std::atomic<std::uint64_t> ReceivedMessages_{0};
+        std::atomic<std::uint64_t> ReceivedBytes_{0};
+        std::array<std::atomic<std::uint64_t>, std::size_t(NetworkTopicType::COUNT)> SentMessages_{};
+        std::array<std::atomic<std::uint64_t>, std::size_t(NetworkTopicType::COUNT)> SentBytes_{};
+
+        std::atomic<std::size_t> Connections_{0};
+        std::atomic<std::size_t> Entities_{0};
+        std::atomic<std::size_t> Stars_{0};
+        std::atomic<std::size_t> Systems_{0};
+        std::atomic<std::size_t> Clients_{0};
+        std::atomic<std::size_t> LocalWorlds_{0};
+        std::atomic<std::size_t> GalaxyChunks_{0};
+        std::atomic<std::size_t> GalaxyChunkStars_{0};
+        std::atomic<std::size_t> LocalWorldsAwake_{0};
+
+};
+
+#endif // METRICS_MANAGER_HPP
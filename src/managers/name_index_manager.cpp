@@ -0,0 +1,58 @@
+#include "name_index_manager.hpp"
+
+#include "trace.hpp"
+
+NameIndexManager::~NameIndexManager()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        IsStopped_ = true;
+    }
+    Condition_.notify_one();
+    if (Thread_.joinable()) Thread_.join();
+}
+
+void NameIndexManager::submit(std::unique_ptr<NameIndex> _Index)
+{
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        Pending_ = std::move(_Index);
+    }
+    if (!Thread_.joinable()) Thread_ = std::thread(&NameIndexManager::run, this);
+    Condition_.notify_one();
+}
+
+void NameIndexManager::wait()
+{
+    std::unique_lock<std::mutex> Lock(Lock_);
+    ConditionPublished_.wait(Lock, [this]{return Pending_ == nullptr && !IsBuilding_;});
+}
+
+void NameIndexManager::run()
+{
+    TRACE_THREAD("name_index");
+
+    while (true)
+    {
+        std::unique_ptr<NameIndex> Index;
+        {
+            std::unique_lock<std::mutex> Lock(Lock_);
+            Condition_.wait(Lock, [this]{return Pending_ != nullptr || IsStopped_;});
+            if (IsStopped_) break;
+            Index = std::move(Pending_);
+            IsBuilding_ = true;
+        }
+
+        {
+            TRACE_ZONE("name_index_build");
+            Index->build();
+            std::atomic_store(&Index_, std::shared_ptr<const NameIndex>(std::move(Index)));
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(Lock_);
+            IsBuilding_ = false;
+        }
+        ConditionPublished_.notify_all();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef NAME_INDEX_MANAGER_HPP
+#define NAME_INDEX_MANAGER_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "name_index.hpp"
+
+// Builds name indices in the background. The simulation thread collects
+// the names (see NameSystem) and submits them, the builder thread sorts and
+// hashes them and publishes the index. Submissions while building are
+// merged, only the latest names are built. Until the first index is
+// published, there are no names to be found.
+class NameIndexManager
+{
+
+    public:
+
+        NameIndexManager() = default;
+        ~NameIndexManager();
+        NameIndexManager(const NameIndexManager&) = delete;
+        NameIndexManager& operator=(const NameIndexManager&) = delete;
+
+        // Simulation thread, names are added but not built yet
+        void submit(std::unique_ptr<NameIndex> _Index);
+
+        // Any thread, nullptr if not built yet
+        std::shared_ptr<const NameIndex> get() const {return std::atomic_load(&Index_);}
+
+        // Blocks until all submitted names are published, e.g. benchmarks
+        void wait();
+
+    private:
+
+        void run();
+
+        std::shared_ptr<const NameIndex> Index_;
+
+        std::mutex                 Lock_;
+        std::condition_variable    Condition_;
+        std::condition_variable    ConditionPublished_;
+        std::unique_ptr<NameIndex> Pending_;
+        bool                       IsBuilding_{false};
+        bool                       IsStopped_{false};
+        std::thread                Thread_;
+
+};
+
+#endif // NAME_INDEX_MANAGER_HPP
@@ -1,10 +1,14 @@
 #include "network_manager.hpp"
 
+#include "command_buffer.hpp"
+#include "input_log.hpp"
 #include "message_handler.hpp"
+#include "metrics_manager.hpp"
 #include "network_message_broker.hpp"
 #include "timer.hpp"
+#include "trace.hpp"
 
-bool NetworkManager::init(moodycamel::ConcurrentQueue<NetworkMessageParsed>* const _QueueNetIn,
+bool NetworkManager::init(moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueNetIn,
                           moodycamel::ConcurrentQueue<NetworkMessage>* const _InputQueue,
                           moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue,
                           int _Port)
@@ -22,9 +26,11 @@ bool NetworkManager::init(moodycamel::ConcurrentQueue<NetworkMessageParsed>* con
     Server_.clear_access_channels(websocketpp::log::alevel::frame_payload);
     Server_.set_error_channels(websocketpp::log::elevel::all);
     Server_.get_elog().set_ostream(&ErrorStream_);
-    Server_.get_alog().set_ostream(&MessageStream_);
+    Server_.get_alog().set_ostream(&AccessStream_);
     Server_.set_close_handler(std::bind(&NetworkManager::onClose, this,
                               std::placeholders::_1));
+    Server_.set_http_handler(std::bind(&NetworkManager::onHttp, this,
+                             std::placeholders::_1));
     Server_.set_message_handler(std::bind(&NetworkManager::onMessage, this,
                                 std::placeholders::_1, std::placeholders::_2));
     Server_.set_validate_handler(std::bind(&NetworkManager::onValidate, this,
@@ -47,7 +53,6 @@ bool NetworkManager::init(moodycamel::ConcurrentQueue<NetworkMessageParsed>* con
     if (ErrorCode)
     {
         Messages.report("net", "Couldn't start server: " + ErrorCode.message());
-        std::cerr << ErrorCode.message() << std::endl;
     }
 
     ThreadServer_ = std::thread(std::bind(&ServerType::run, &Server_));
@@ -66,20 +71,54 @@ void NetworkManager::onClose(websocketpp::connection_hdl _Connection)
     Connections_.erase(_Connection);
     ConIDToHdl_.erase(ID);
     ConHdlToID_.erase(_Connection);
-    Reg_.destroy(entt::entity(ID));
+    ConnectionIDs_.destroy(ID);
+    Reg_.ctx<MetricsManager>().setConnections(Connections_.size());
 
-    Messages.report("net", "Connection to client ID "+std::to_string(entt::to_integral(ID)) + " closed ("+std::to_string(Connections_.size())+ " open connection(s)).", MessageHandler::INFO);
+    RegClients_.ctx<CommandBuffer>().record([this, ID](entt::registry& _Reg)
+    {
+        if (_Reg.valid(ID)) _Reg.destroy(ID);
+
+        // Applied by simulation thread, hence, it's tagged with the right tick
+        if (auto* InputLog = Reg_.try_ctx<InputLogWriter>()) InputLog->recordDisconnect(ID);
+    });
+
+    MSG_REPORT(Messages, "net", "Connection to client ID "+std::to_string(entt::to_integral(ID)) + " closed ("+std::to_string(Connections_.size())+ " open connection(s)).", MessageHandler::INFO);
+}
+
+void NetworkManager::onHttp(websocketpp::connection_hdl _Connection)
+{
+    auto Con = Server_.get_con_from_hdl(_Connection);
+
+    DBLK(MSG_REPORT(Reg_.ctx<MessageHandler>(), "net", "HTTP request: " + Con->get_resource(), MessageHandler::DEBUG_L2);)
+
+    // Plain HTTP requests on the websocket port, only used for metrics
+    if (Con->get_resource() == "/metrics")
+    {
+        Con->set_body(Reg_.ctx<MetricsManager>().getText());
+        Con->append_header("Content-Type", "text/plain; version=0.0.4");
+        Con->set_status(websocketpp::http::status_code::ok);
+    }
+    else
+    {
+        Con->set_body("Not found\n");
+        Con->set_status(websocketpp::http::status_code::not_found);
+    }
 }
 
 void NetworkManager::onMessage(websocketpp::connection_hdl _Connection, ServerType::message_ptr _Msg)
 {
+    TRACE_ZONE("net_receive");
+
     auto& Messages = Reg_.ctx<MessageHandler>();
 
     DBLK(Messages.report("net", "Enqueueing incoming message from ID: "
                          + std::to_string(entt::to_integral(ConHdlToID_[_Connection]))+"\n"
                          + _Msg->get_payload(), MessageHandler::DEBUG_L3);)
 
-    InputQueue_->enqueue({ConHdlToID_[_Connection], _Msg->get_payload()});
+    Reg_.ctx<MetricsManager>().countReceived(_Msg->get_payload().size());
+
+    // Payload is moved, it's parsed in-situ by the broker
+    InputQueue_->enqueue({ConHdlToID_[_Connection], std::move(_Msg->get_raw_payload())});
 }
 
 bool NetworkManager::onValidate(websocketpp::connection_hdl _Connection)
@@ -90,18 +129,27 @@ bool NetworkManager::onValidate(websocketpp::connection_hdl _Connection)
         Connection = Server_.get_con_from_hdl(_Connection);
     websocketpp::uri_ptr Uri = Connection->get_uri();
 
-    DBLK(Messages.report("net", "Query string: " + Uri->get_query(), MessageHandler::DEBUG_L1);)
+    DBLK(MSG_REPORT(Messages, "net", "Query string: " + Uri->get_query(), MessageHandler::DEBUG_L1);)
 
     std::lock_guard<std::mutex> Lock(ConnectionsLock_);
 
     // Store connection data and a unique id for further
     // assignment of message queries
     Connections_.insert(_Connection);
-    auto e = Reg_.create();
+    auto e = ConnectionIDs_.create();
     ConIDToHdl_[e] = _Connection;
     ConHdlToID_[_Connection] = e;
+    Reg_.ctx<MetricsManager>().setConnections(Connections_.size());
 
-    Messages.report("net", "Connection to client ID " + std::to_string(entt::to_integral(e)) + " validated ("+std::to_string(Connections_.size())+ " open connection(s)).", MessageHandler::INFO);
+    RegClients_.ctx<CommandBuffer>().record([this, e](entt::registry& _Reg)
+    {
+        // Use ID as hint, both registries share the same client IDs
+        static_cast<void>(_Reg.create(e));
+
+        if (auto* InputLog = Reg_.try_ctx<InputLogWriter>()) InputLog->recordConnect(e);
+    });
+
+    MSG_REPORT(Messages, "net", "Connection to client ID " + std::to_string(entt::to_integral(e)) + " validated ("+std::to_string(Connections_.size())+ " open connection(s)).", MessageHandler::INFO);
 
     return true;
 }
@@ -110,58 +158,49 @@ void NetworkManager::run()
 {
     auto& Messages = Reg_.ctx<MessageHandler>();
     auto& Broker = Reg_.ctx<NetworkMessageBroker>();
+    auto& Metrics = Reg_.ctx<MetricsManager>();
     Timer NetworkTimer;
 
     Messages.report("net", "Network Manager running", MessageHandler::INFO);
+    TRACE_THREAD("net_sender");
 
     while (IsRunning_)
     {
         NetworkTimer.start();
 
-        // Check, if there are any errors or messages from
-        // websocketpp.
-        // Since output is transferred to a (string-)stream,
-        // it's content is frequently checked
-        if (!ErrorStream_.str().empty())
-        {
-            // Extract line by line in case of multiple messages
-            std::string Line;
-            while (std::getline(ErrorStream_, Line, '\n'))
-            {
-                Messages.report("net", "Websocket++: "+Line);
-            }
-            ErrorStream_.str({});
-        }
-        DBLK(
-            if (!MessageStream_.str().empty())
-            {
-                std::string Line;
-                while(std::getline(MessageStream_, Line, '\n'))
-                {
-                    Messages.report("net", "Websocket++: "+Line, MessageHandler::DEBUG_L1);
-                }
-                MessageStream_.str({});
-            }
-        )
-
+        TRACE_ZONE_NAMED(SendZone, "net_send");
         NetworkMessage Message;
         while (OutputQueue_->try_dequeue(Message))
         {
-            auto Con = ConIDToHdl_[Message.ClientID];
+            websocketpp::connection_hdl Con;
+            {
+                std::lock_guard<std::mutex> Lock(ConnectionsLock_);
+                auto it = ConIDToHdl_.find(Message.ClientID);
+                if (it == ConIDToHdl_.end()) continue;
+                Con = it->second;
+            }
             websocketpp::lib::error_code ErrorCode;
-            Server_.send(Con, Message.Payload, websocketpp::frame::opcode::text, ErrorCode);
+            Server_.send(Con, Message.Payload,
+                         Message.IsBinary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text,
+                         ErrorCode);
             if (ErrorCode)
             {
                 Messages.report("net", "Sending failed: " + ErrorCode.message());
             }
+            else
+            {
+                Metrics.countSent(Message.Topic, Message.Payload.size());
+            }
 
         }
 
-        NetworkMessageParsed d;
+        TRACE_ZONE_END(SendZone);
+
+        NetworkCommand Cmd;
 
-        while (QueueNetIn_->try_dequeue(d))
+        while (QueueNetIn_->try_dequeue(Cmd))
         {
-            Broker.executeNet(d);
+            Broker.executeNet(Cmd);
         }
 
         NetworkTimer.stop();
@@ -3,8 +3,8 @@
 
 #include <map>
 #include <mutex>
+#include <ostream>
 #include <set>
-#include <sstream>
 #include <string>
 #include <thread>
 
@@ -15,6 +15,8 @@
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
 
+#include "message_handler.hpp"
+#include "network_command.hpp"
 #include "network_message.hpp"
 
 class NetworkManager
@@ -24,11 +26,15 @@ class NetworkManager
 
         typedef websocketpp::server<websocketpp::config::asio> ServerType;
 
-        NetworkManager(entt::registry& _Reg) : Reg_(_Reg) {}
+        NetworkManager(entt::registry& _Reg, entt::registry& _RegClients) :
+            Reg_(_Reg),
+            RegClients_(_RegClients),
+            AccessStreamBuffer_(_Reg.ctx<MessageHandler>(), "net", "Websocket++: ", MessageHandler::DEBUG_L1),
+            ErrorStreamBuffer_(_Reg.ctx<MessageHandler>(), "net", "Websocket++: ", MessageHandler::ERROR) {}
 
         bool isRunning() const {return IsRunning_;}
 
-        bool init(moodycamel::ConcurrentQueue<NetworkMessageParsed>* const _QueueNetIn,
+        bool init(moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueNetIn,
                   moodycamel::ConcurrentQueue<NetworkMessage>* const _InputQueue,
                   moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue,
                   int _Port);
@@ -37,16 +43,21 @@ class NetworkManager
     private:
 
         void onClose(websocketpp::connection_hdl);
+        void onHttp(websocketpp::connection_hdl);
         void onMessage(websocketpp::connection_hdl, ServerType::message_ptr _Msg);
         bool onValidate(websocketpp::connection_hdl);
         void run();
 
         entt::registry& Reg_;
+        entt::registry& RegClients_; // Owned by simulation thread, use command buffer
 
-        std::stringstream ErrorStream_;
-        std::stringstream MessageStream_;
+        // Websocket++ logs are redirected to the message handler line by line
+        MessageStreamBuffer AccessStreamBuffer_;
+        MessageStreamBuffer ErrorStreamBuffer_;
+        std::ostream AccessStream_{&AccessStreamBuffer_};
+        std::ostream ErrorStream_{&ErrorStreamBuffer_};
 
-        moodycamel::ConcurrentQueue<NetworkMessageParsed>* QueueNetIn_{nullptr};
+        moodycamel::ConcurrentQueue<NetworkCommand>* QueueNetIn_{nullptr};
         moodycamel::ConcurrentQueue<NetworkMessage>* InputQueue_{nullptr};
         moodycamel::ConcurrentQueue<NetworkMessage>* OutputQueue_{nullptr};
 
@@ -61,6 +72,10 @@ class NetworkManager
         std::map<websocketpp::connection_hdl, entt::entity, std::owner_less<websocketpp::connection_hdl>> ConHdlToID_;
         std::map<entt::entity, websocketpp::connection_hdl> ConIDToHdl_;
 
+        // Client IDs are generated here and mirrored to the client registry
+        // of the simulation thread by the client command buffer
+        entt::registry ConnectionIDs_;
+
         //--- Threads ---//
         std::thread ThreadSender_;
         std::thread ThreadServer_;
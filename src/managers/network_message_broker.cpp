@@ -1,485 +1,623 @@
 #include "network_message_broker.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string_view>
+
+#include <rapidjson/error/en.h>
+
+#include "checkpoint_manager.hpp"
+#include "galaxy_chunk_manager.hpp"
 #include "message_handler.hpp"
 #include "network_manager.hpp"
 #include "simulation_manager.hpp"
 #include "subscription_components.hpp"
+#include "trace.hpp"
 
 NetworkMessageBroker::NetworkMessageBroker(entt::registry& _Reg,
-                    moodycamel::ConcurrentQueue<NetworkMessageClassified>* _QueueToSim,
-                    moodycamel::ConcurrentQueue<NetworkMessageParsed>* _QueueToNet,
+                    entt::registry& _RegClients,
+                    moodycamel::ConcurrentQueue<NetworkCommand>* _QueueToSim,
+                    moodycamel::ConcurrentQueue<NetworkCommand>* _QueueToNet,
                     moodycamel::ConcurrentQueue<NetworkMessage>* _QueueOut) :
                     Reg_(_Reg),
+                    RegClients_(_RegClients),
+                    Json_(_Reg),
                     QueueToSim_(_QueueToSim),
                     QueueToNet_(_QueueToNet),
                     QueueOut_(_QueueOut)
 {
-    //--- Distribution of messagas ---//
+}
 
-    auto& Messages = Reg_.ctx<MessageHandler>();
-    Domains_.insert({"cmd_accelerate_simulation", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->distributeCommand(_m, _c, "Simulation acceleration");
-    }});
-    Domains_.insert({"cmd_start_simulation", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->distributeCommand(_m, _c, "Simulation start");
-    }});
-    Domains_.insert({"cmd_stop_simulation", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->distributeCommand(_m, _c, "Simulation stop");
-    }});
-    Domains_.insert({"sub_dynamic_data", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->sub(_m, _c, "dynamic data");
-    }});
-    Domains_.insert({"uns_dynamic_data", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->unsub(_m, _c, "dynamic data");
-    }});
-    Domains_.insert({"sub_galaxy_data", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->sub(_m, _c, "galaxy data");
-    }});
-    Domains_.insert({"uns_galaxy_data", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->unsub(_m, _c, "galaxy data");
-    }});
-    Domains_.insert({"sub_perf_stats", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
-    {
-        this->sub(_m, _c, "performance stats");
-    }});
-    Domains_.insert({"uns_perf_stats", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
+void NetworkMessageBroker::process(NetworkMessage& _m)
+{
+    TRACE_ZONE("broker_process");
+
+    auto Doc = DocumentPool_.acquire();
+    if (!this->parse(_m, *Doc)) return;
+
+    if (Doc->IsArray())
     {
-        this->unsub(_m, _c, "performance stats");
-    }});
-    Domains_.insert({"sub_sim_stats", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
+        this->processBatch(_m.ClientID, *Doc);
+    }
+    else
     {
-        this->sub(_m, _c, "sim stats");
-    }});
-    Domains_.insert({"uns_sim_stats", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
+        this->processRequest({_m.ClientID, &(*Doc)});
+    }
+}
+
+void NetworkMessageBroker::processBatch(JsonManager::ClientIDType _ClientID, const rapidjson::Value& _Batch)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    if (_Batch.Empty())
     {
-        this->unsub(_m, _c, "sim stats");
-    }});
-    Domains_.insert({"sub_system", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
+        MSG_REPORT(Messages, "brk", "Empty batch request from client "+std::to_string(entt::to_integral(_ClientID)), MessageHandler::WARNING);
+        this->sendError(JsonManager::ErrorType::REQUEST, _ClientID, 0, "Empty batch");
+        return;
+    }
+
+    DBLK(MSG_REPORT(Messages, "brk", "Processing batch of "+std::to_string(_Batch.Size())+" requests", MessageHandler::DEBUG_L1);)
+
+    // All responses created by the broker while processing the batch are
+    // collected. Data sent later by the simulation thread (e.g. galaxy data
+    // on subscription) isn't part of the batch response.
+    IsBatch_ = true;
+    BatchCount_ = 0;
+    BatchBuffer_.clear();
+    BatchBuffer_ += '[';
+
+    for (const auto& r : _Batch.GetArray())
     {
-        this->sub(_m, _c, "system");
-    }});
-    Domains_.insert({"uns_system", [&](const NetworkMessageParsed& _m, NetworkMessageClassificationType _c)
+        this->processRequest({_ClientID, &r});
+    }
+
+    IsBatch_ = false;
+    if (BatchCount_ > 0)
     {
-        this->unsub(_m, _c, "system");
-    }});
+        BatchBuffer_ += ']';
+        QueueOut_->enqueue({_ClientID, BatchBuffer_});
+    }
+}
+
+void NetworkMessageBroker::processRequest(const NetworkMessageParsed& _d)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
 
-    //--- Processing of messagas ---//
-    //
-    ActionsMain_.insert({"cmd_shutdown", [&](const NetworkMessageParsed& _d)
+    if (JsonManager::checkRequest(*_d.Payload) == true)
     {
-        Messages.report("brk", "Server shutdown requested", MessageHandler::INFO);
-        auto& Json = Reg_.ctx<JsonManager>();
-        auto r = Json.checkParams(_d.Payload, {});
-        if (r.Success)
+        DBLK(Messages.report("brk", "Distributing message", MessageHandler::DEBUG_L1);)
+        this->distribute(_d);
+    }
+    else
+    {
+        MSG_REPORT(Messages, "brk", "Invalid jsonrpc request from client "+std::to_string(entt::to_integral(_d.ClientID)), MessageHandler::WARNING);
+        if (JsonManager::checkID(*_d.Payload) == true)
         {
-            DBLK(Messages.report("brk", "Shutting down simulation...", MessageHandler::DEBUG_L1);)
-            Reg_.ctx<SimulationManager>().shutdown();
-            std::this_thread::sleep_for(std::chrono::seconds(2));
-            DBLK(Messages.report("brk", "Shutting down network...", MessageHandler::DEBUG_L1);)
-            Reg_.ctx<NetworkManager>().stop();
-            DBLK(Messages.report("brk", "...done", MessageHandler::DEBUG_L1);)
-            this->sendSuccess(_d.ClientID, JsonManager::getID(_d.Payload));
+            this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, JsonManager::getID(*_d.Payload), "Missing field <method>");
         }
         else
         {
-            this->sendError(_d.ClientID, r);
+            if (JsonManager::checkMethod(*_d.Payload))
+            {
+                this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, 0, "Missing fields <id>");
+            }
+            else
+            {
+                this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, 0, "Missing field <method>/<id>");
+            }
         }
-    }});
+    }
+}
 
-    ActionsSim_.insert({"cmd_accelerate_simulation", [&](const NetworkMessageClassified& _d)
+void NetworkMessageBroker::executeMain(const NetworkCommand& _c)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    switch (_c.Method)
     {
-        DBLK(Messages.report("brk", "Accelerating simulation", MessageHandler::DEBUG_L1);)
-        auto& Json = Reg_.ctx<JsonManager>();
-        auto r = Json.checkParams(_d.Payload, {JsonManager::ParamsType::NUMBER});
-        if (r.Success)
+        case NetworkMethodType::CMD_DUMP_TRACE:
         {
-            auto Accel = JsonManager::getParams(_d.Payload)[0].GetDouble();
-            if (Accel > 1.0e6)
+            if (!Tracer::isEnabled())
             {
-                Accel = 1.0e6;
-                Json.createResult()
-                    .beginObject()
-                    .addNamedValue("success", true)
-                    .addNamedValue("notification", "Out of bounds, valid interval is [0.1, 1.0e6]. Clamping value.")
-                    .endObject()
-                    .finalise(JsonManager::getID(_d.Payload));
-                QueueOut_->enqueue({_d.ClientID, Json.getString()});
+                this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Tracing disabled");
+                break;
             }
-            else if (Accel < 0.1)
+            const auto FileName = Tracer::createFileName();
+            if (Tracer::get().dump(FileName))
             {
-                Accel = 0.1;
-                Json.createResult()
-                    .beginObject()
-                    .addNamedValue("success", true)
-                    .addNamedValue("notification", "Out of bounds, valid interval is [0.1, 1.0e6]. Clamping value.")
-                    .endObject()
-                    .finalise(JsonManager::getID(_d.Payload));
+                Messages.report("brk", "Trace written to "+FileName, MessageHandler::INFO);
+                Json_.createResult(FileName)
+                    .finalise(_c.RequestID);
+                this->send(_c.ClientID);
             }
             else
             {
-                this->sendSuccess(_d.ClientID, JsonManager::getID(_d.Payload));
+                Messages.report("brk", "Couldn't write trace to "+FileName);
+                this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Couldn't write trace");
             }
-            Reg_.ctx<SimulationManager>().setAccel(Accel);
-        }
-        else
-        {
-            this->sendError(_d.ClientID, r);
+            break;
         }
-    }});
-    ActionsSim_.insert({"cmd_start_simulation", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Starting simulation", MessageHandler::DEBUG_L1);)
-        auto& Json = Reg_.ctx<JsonManager>();
-        auto r = Json.checkParams(_d.Payload, {});
-        if (r.Success)
-        {
-            Reg_.ctx<SimulationManager>().start();
-            this->sendSuccess(_d.ClientID, JsonManager::getID(_d.Payload));
-        }
-        else
-        {
-            this->sendError(_d.ClientID, r);
-        }
-    }});
-    ActionsSim_.insert({"cmd_stop_simulation", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Stopping simulation", MessageHandler::DEBUG_L1);)
-        auto& Json = Reg_.ctx<JsonManager>();
-        auto r = Json.checkParams(_d.Payload, {});
-        if (r.Success)
-        {
-            Reg_.ctx<SimulationManager>().stop();
-            this->sendSuccess(_d.ClientID, JsonManager::getID(_d.Payload));
-        }
-        else
-        {
-            this->sendError(_d.ClientID, r);
-        }
-    }});
-    ActionsSim_.insert({"sub_dynamic_data", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Subscribing on dynamic data", MessageHandler::DEBUG_L1);)
-        Reg_.emplace_or_replace<DynamicDataSubscriptionComponent>(_d.ClientID);
-    }});
-    ActionsSim_.insert({"uns_dynamic_data", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Unsubscribing from dynamic data", MessageHandler::DEBUG_L1);)
-        Reg_.remove<DynamicDataSubscriptionComponent>(_d.ClientID);
-    }});
-    ActionsSim_.insert({"sub_galaxy_data", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Subscribing on galaxy data", MessageHandler::DEBUG_L1);)
-        if (_d.Class == NetworkMessageClassificationType::EVT)
+        case NetworkMethodType::CMD_FIND_NAME:
+        case NetworkMethodType::CMD_SEARCH_NAME:
+        case NetworkMethodType::CMD_SEARCH_NAME_FUZZY:
+            this->sendNameMatches(_c);
+            break;
+        case NetworkMethodType::CMD_GALAXY_CHUNK:
+            this->sendGalaxyChunk(_c);
+            break;
+        case NetworkMethodType::CMD_GALAXY_DENSITY:
+            this->sendGalaxyDensity(_c);
+            break;
+        case NetworkMethodType::CMD_SAVE_CHECKPOINT:
         {
-            Reg_.emplace_or_replace<GalaxyDataSubscriptionComponent>(_d.ClientID);
-        }
-        else
-        {
-            Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-            this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [evt]");
+            auto& Checkpoints = Reg_.ctx<CheckpointManager>();
+            if (!Checkpoints.isEnabled())
+            {
+                this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Checkpoints disabled");
+                break;
+            }
+            // Taken by simulation thread at next tick boundary
+            Checkpoints.request();
+            this->sendSuccess(_c.ClientID, _c.RequestID);
+            break;
         }
+        case NetworkMethodType::CMD_SHUTDOWN:
+            DBLK(Messages.report("brk", "Shutting down simulation...", MessageHandler::DEBUG_L1);)
+            Reg_.ctx<SimulationManager>().shutdown();
+            std::this_thread::sleep_for(std::chrono::seconds(2));
+            DBLK(Messages.report("brk", "Shutting down network...", MessageHandler::DEBUG_L1);)
+            Reg_.ctx<NetworkManager>().stop();
+            DBLK(Messages.report("brk", "...done", MessageHandler::DEBUG_L1);)
+            this->sendSuccess(_c.ClientID, _c.RequestID);
+            break;
+        default:
+            Messages.report("brk", "Method not executable by main thread", MessageHandler::WARNING);
+            break;
+    }
+}
 
-    }});
-    ActionsSim_.insert({"uns_galaxy_data", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Unsubscribing from galaxy data", MessageHandler::DEBUG_L1);)
-        if (_d.Class == NetworkMessageClassificationType::EVT)
-        {
-            Reg_.remove<GalaxyDataSubscriptionComponent>(_d.ClientID);
-        }
-        else
-        {
-            Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-            this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [evt]");
-        }
+void NetworkMessageBroker::executeNet(const NetworkCommand& _c)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
 
-    }});
-    ActionsSim_.insert({"sub_perf_stats", [&](const NetworkMessageClassified& _d)
+    // There are no methods routed to the network thread, yet
+    MSG_REPORT(Messages, "brk", "Method not executable by network thread: "+
+                         std::to_string(int(_c.Method)), MessageHandler::WARNING);
+}
+
+void NetworkMessageBroker::executeSim(const NetworkCommand& _c)
+{
+    TRACE_ZONE("broker_execute_sim");
+
+    // Client might have disconnected while its request was still queued
+    if (!RegClients_.valid(_c.ClientID))
     {
-        DBLK(Messages.report("brk", "Subscribing on performance stats", MessageHandler::DEBUG_L1);)
-        switch (_d.Class)
+        DBLK(MSG_REPORT(Reg_.ctx<MessageHandler>(), "brk", "Dropping request of disconnected client "+
+                                                    std::to_string(entt::to_integral(_c.ClientID)), MessageHandler::DEBUG_L1);)
+        return;
+    }
+
+    auto& Simulation = Reg_.ctx<SimulationManager>();
+
+    // Commands are decoded and validated by the broker, hence, they are
+    // simply applied here
+    switch (_c.Method)
+    {
+        case NetworkMethodType::CMD_ACCELERATE_SIMULATION:
+            Simulation.setAccel(_c.Number);
+            break;
+        case NetworkMethodType::CMD_PARTICLE_POPULATION:
+            Simulation.queueParticlePopulation(_c.ClientID, _c.RequestID, entt::entity(std::uint32_t(_c.Number)),
+                                               std::uint32_t(_c.Number2));
+            break;
+        case NetworkMethodType::CMD_RESET_PERF_STATS:
+            Simulation.resetPerfStats();
+            break;
+        case NetworkMethodType::CMD_START_SIMULATION:
+            Simulation.start();
+            break;
+        case NetworkMethodType::CMD_STOP_SIMULATION:
+            Simulation.stop();
+            break;
+        case NetworkMethodType::SUB_DYNAMIC_DATA:
+            RegClients_.emplace_or_replace<DynamicDataSubscriptionComponent>(_c.ClientID);
+            break;
+        case NetworkMethodType::UNS_DYNAMIC_DATA:
+            RegClients_.remove<DynamicDataSubscriptionComponent>(_c.ClientID);
+            break;
+        case NetworkMethodType::SUB_GALAXY_DATA:
+            RegClients_.emplace_or_replace<GalaxyDataSubscriptionComponent>(_c.ClientID, false, _c.RequestID);
+            break;
+        case NetworkMethodType::UNS_GALAXY_DATA:
+            RegClients_.remove<GalaxyDataSubscriptionComponent>(_c.ClientID);
+            break;
+        case NetworkMethodType::SUB_PERF_STATS:
+            this->subscribe<PerformanceStatsSubscriptionTag01,
+                            PerformanceStatsSubscriptionTag05,
+                            PerformanceStatsSubscriptionTag1,
+                            PerformanceStatsSubscriptionTag5,
+                            PerformanceStatsSubscriptionTag10>(_c);
+            break;
+        case NetworkMethodType::UNS_PERF_STATS:
+            this->unsubscribe<PerformanceStatsSubscriptionTag01,
+                              PerformanceStatsSubscriptionTag05,
+                              PerformanceStatsSubscriptionTag1,
+                              PerformanceStatsSubscriptionTag5,
+                              PerformanceStatsSubscriptionTag10>(_c);
+            break;
+        case NetworkMethodType::SUB_SIM_STATS:
+            this->subscribe<SimStatsSubscriptionTag01,
+                            SimStatsSubscriptionTag05,
+                            SimStatsSubscriptionTag1,
+                            SimStatsSubscriptionTag5,
+                            SimStatsSubscriptionTag10>(_c);
+            break;
+        case NetworkMethodType::UNS_SIM_STATS:
+            this->unsubscribe<SimStatsSubscriptionTag01,
+                              SimStatsSubscriptionTag05,
+                              SimStatsSubscriptionTag1,
+                              SimStatsSubscriptionTag5,
+                              SimStatsSubscriptionTag10>(_c);
+            break;
+        case NetworkMethodType::SUB_SYSTEM:
         {
-            case NetworkMessageClassificationType::S01:
-                Reg_.emplace_or_replace<PerformanceStatsSubscriptionTag01>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S05:
-                Reg_.emplace_or_replace<PerformanceStatsSubscriptionTag05>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S1:
-                Reg_.emplace_or_replace<PerformanceStatsSubscriptionTag1>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S5:
-                Reg_.emplace_or_replace<PerformanceStatsSubscriptionTag5>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S10:
-                Reg_.emplace_or_replace<PerformanceStatsSubscriptionTag10>(_d.ClientID);
-                break;
-            default:
-                Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-                this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [s01, s05, s1, s5, s10]");
+            // Star system was resolved by name before
+            const auto System = entt::entity(std::uint32_t(_c.Number));
+            if (!Reg_.valid(System)) break;
+            auto& Sub = RegClients_.get_or_emplace<StarSystemsSubscriptionComponent>(_c.ClientID);
+            const auto End = Sub.Systems.begin() + Sub.Nr;
+            if (std::find(Sub.Systems.begin(), End, System) != End) break;
+            if (Sub.Nr == SYS_MAX)
+            {
+                Reg_.ctx<MessageHandler>().report("brk", "Too many star system subscriptions", MessageHandler::WARNING);
                 break;
+            }
+            Sub.Systems[Sub.Nr++] = System;
+            break;
         }
-    }});
-    ActionsSim_.insert({"uns_perf_stats", [&](const NetworkMessageClassified& _d)
-    {
-        DBLK(Messages.report("brk", "Unsubscribing from performance stats", MessageHandler::DEBUG_L1);)
-        switch (_d.Class)
+        case NetworkMethodType::UNS_SYSTEM:
         {
-            case NetworkMessageClassificationType::S01:
-                Reg_.remove<PerformanceStatsSubscriptionTag01>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S05:
-                Reg_.remove<PerformanceStatsSubscriptionTag05>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S1:
-                Reg_.remove<PerformanceStatsSubscriptionTag1>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S5:
-                Reg_.remove<PerformanceStatsSubscriptionTag5>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S10:
-                Reg_.remove<PerformanceStatsSubscriptionTag10>(_d.ClientID);
-                break;
-            default:
-                Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-                this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [s01, s05, s1, s5, s10]");
-                break;
+            auto* Sub = RegClients_.try_get<StarSystemsSubscriptionComponent>(_c.ClientID);
+            if (Sub == nullptr) break;
+            const auto End = Sub->Systems.begin() + Sub->Nr;
+            const auto it = std::remove(Sub->Systems.begin(), End, entt::entity(std::uint32_t(_c.Number)));
+            Sub->Nr = int(it - Sub->Systems.begin());
+            if (Sub->Nr == 0) RegClients_.remove<StarSystemsSubscriptionComponent>(_c.ClientID);
+            break;
         }
-    }});
-    ActionsSim_.insert({"sub_sim_stats", [&](const NetworkMessageClassified& _d)
+        default:
+            break;
+    }
+}
+
+bool NetworkMessageBroker::checkParticlePopulation(const NetworkCommand& _c)
+{
+    // Star system is checked by the simulation thread, which answers with
+    // the frame (or an error) instead of an acknowledgement
+    constexpr double Limit = double(std::numeric_limits<std::uint32_t>::max());
+    if (_c.Number < 0.0 || _c.Number > Limit || _c.Number != std::floor(_c.Number))
     {
-        DBLK(Messages.report("brk", "Subscribing on simulation stats", MessageHandler::DEBUG_L1);)
-        switch (_d.Class)
-        {
-            case NetworkMessageClassificationType::S01:
-                Reg_.emplace_or_replace<SimStatsSubscriptionTag01>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S05:
-                Reg_.emplace_or_replace<SimStatsSubscriptionTag05>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S1:
-                Reg_.emplace_or_replace<SimStatsSubscriptionTag1>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S5:
-                Reg_.emplace_or_replace<SimStatsSubscriptionTag5>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S10:
-                Reg_.emplace_or_replace<SimStatsSubscriptionTag10>(_d.ClientID);
-                break;
-            default:
-                Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-                this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [s01, s05, s1, s5, s10]");
-                break;
-        }
-    }});
-    ActionsSim_.insert({"uns_sim_stats", [&](const NetworkMessageClassified& _d)
+        this->sendError(JsonManager::ErrorType::PARAMS, _c.ClientID, _c.RequestID, "Invalid star system");
+        return false;
+    }
+    if (_c.Number2 < 0.0 || _c.Number2 > PARTICLE_DENSITY_CELLS_MAX || _c.Number2 != std::floor(_c.Number2))
     {
-        DBLK(Messages.report("brk", "Unsubscribing from simulation stats", MessageHandler::DEBUG_L1);)
-        switch (_d.Class)
-        {
-            case NetworkMessageClassificationType::S01:
-                Reg_.remove<SimStatsSubscriptionTag01>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S05:
-                Reg_.remove<SimStatsSubscriptionTag05>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S1:
-                Reg_.remove<SimStatsSubscriptionTag1>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S5:
-                Reg_.remove<SimStatsSubscriptionTag5>(_d.ClientID);
-                break;
-            case NetworkMessageClassificationType::S10:
-                Reg_.remove<SimStatsSubscriptionTag10>(_d.ClientID);
-                break;
-            default:
-                Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
-                this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload), "Allowed subscription types: [s01, s05, s1, s5, s10]");
-                break;
-        }
-    }});
+        const auto Text = "Invalid number of cells, valid are 0 (particles) to "+std::to_string(PARTICLE_DENSITY_CELLS_MAX);
+        this->sendError(JsonManager::ErrorType::PARAMS, _c.ClientID, _c.RequestID, Text.c_str());
+        return false;
+    }
+    return true;
 }
 
-void NetworkMessageBroker::process(const NetworkMessage& _m)
+bool NetworkMessageBroker::decode(const NetworkMessageParsed& _d, NetworkCommand& _c, const NetworkMethodEntry*& _Entry)
 {
-    auto _d = this->parse(_m);
-
     auto& Messages = Reg_.ctx<MessageHandler>();
 
-    if (JsonManager::checkRequest(_d.Payload) == true)
+    const std::string_view Method{JsonManager::getMethod(*_d.Payload)};
+    const auto Prefix = Method.substr(0, 3);
+
+    _c.ClientID = _d.ClientID;
+    _c.RequestID = JsonManager::getID(*_d.Payload);
+    _c.Class = NetworkMessageClassificationType::CMD;
+
+    std::string_view Name{Method};
+
+    if (Prefix == "sub" || Prefix == "uns")
+    {
+        // Split frequency suffix, e.g. sub_perf_stats_s01
+        const auto p = Method.find_last_of('_');
+        const auto Suffix = Method.substr(p+1);
+        Name = Method.substr(0, p);
+        _c.Class = toNetworkClassification(Suffix);
+        if (_c.Class == NetworkMessageClassificationType::INVALID)
+        {
+            Messages.report("brk", "Unknown suffix for subscription frequency", MessageHandler::WARNING);
+            this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID);
+            return false;
+        }
+        DBLK(MSG_REPORT(Messages, "brk", "Requested subscription frequency: "+std::string(Suffix), MessageHandler::DEBUG_L1);)
+    }
+    else if (Prefix != "cmd")
     {
-        const auto c = JsonManager::getMethod(_d.Payload);
-        if (ActionsMain_.find(c) != ActionsMain_.end())
+        Messages.report("brk", "Unknown prefix or missing, should be <cmd_>/<sub_>/<uns_>", MessageHandler::WARNING);
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID);
+        return false;
+    }
+
+    _Entry = lookupNetworkMethod(Name);
+    if (_Entry == nullptr)
+    {
+        MSG_REPORT(Messages, "brk", "Unknown method "+std::string(Name), MessageHandler::WARNING);
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID);
+        return false;
+    }
+    _c.Method = _Entry->Method;
+
+    if ((toNetworkClassBit(_c.Class) & _Entry->Classes) == 0u)
+    {
+        Messages.report("brk", "Invalid subscription type", MessageHandler::WARNING);
+        // Allowed text is a string literal, hence, null-terminated
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, _Entry->AllowedText.data());
+        return false;
+    }
+
+    // Parameters are only relevant for commands and subscriptions expecting
+    // them
+    if (_c.Class == NetworkMessageClassificationType::CMD || _Entry->Params != NetworkParamsType::NONE)
+    {
+        std::vector<JsonManager::ParamsType> Params;
+        if (_Entry->Params == NetworkParamsType::NUMBER) Params.push_back(JsonManager::ParamsType::NUMBER);
+        if (_Entry->Params == NetworkParamsType::NUMBER_PAIR) Params.assign(2, JsonManager::ParamsType::NUMBER);
+        if (_Entry->Params == NetworkParamsType::STRING) Params.push_back(JsonManager::ParamsType::STRING);
+
+        auto r = Json_.checkParams(*_d.Payload, Params);
+        if (!r.Success)
         {
-            DBLK(Messages.report("brk", "Processing message", MessageHandler::DEBUG_L3);)
-            ActionsMain_[c](_d);
+            this->sendError(_c.ClientID, r);
+            return false;
         }
-        else
+        if (_Entry->Params == NetworkParamsType::NUMBER)
         {
-            DBLK(Messages.report("brk", "Distributing message", MessageHandler::DEBUG_L1);)
-            this->distribute(_d);
+            _c.Number = JsonManager::getParams(*_d.Payload)[0].GetDouble();
         }
-    }
-    else
-    {
-        Messages.report("brk", "Invalid jsonrpc request from client "+std::to_string(entt::to_integral(_d.ClientID)), MessageHandler::WARNING);
-        if (JsonManager::checkID(_d.Payload) == true)
+        else if (_Entry->Params == NetworkParamsType::NUMBER_PAIR)
         {
-            this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, JsonManager::getID(_d.Payload), "Missing field <method>");
+            _c.Number = JsonManager::getParams(*_d.Payload)[0].GetDouble();
+            _c.Number2 = JsonManager::getParams(*_d.Payload)[1].GetDouble();
         }
-        else
+        else if (_Entry->Params == NetworkParamsType::STRING)
         {
-            if (JsonManager::checkMethod(_d.Payload))
-            {
-                this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, 0, "Missing fields <id>");
-            }
-            else
-            {
-                this->sendError(JsonManager::ErrorType::REQUEST, _d.ClientID, 0, "Missing field <method>/<id>");
-            }
+            const auto& p = JsonManager::getParams(*_d.Payload)[0];
+            Text_.assign(p.GetString(), p.GetStringLength());
         }
     }
+    return true;
 }
 
-void NetworkMessageBroker::executeNet(const NetworkMessageParsed& _d)
+void NetworkMessageBroker::distribute(const NetworkMessageParsed& _d)
 {
     auto& Messages = Reg_.ctx<MessageHandler>();
 
-    const auto c = JsonManager::getMethod(_d.Payload);
-    if (ActionsNet_.find(c) != ActionsNet_.end())
+    NetworkCommand Cmd;
+    const NetworkMethodEntry* Entry{nullptr};
+
+    if (!this->decode(_d, Cmd, Entry)) return;
+
+    if ((Cmd.Method == NetworkMethodType::SUB_SYSTEM || Cmd.Method == NetworkMethodType::UNS_SYSTEM) &&
+        !this->resolveStarSystem(Cmd)) return;
+    if (Cmd.Method == NetworkMethodType::CMD_PARTICLE_POPULATION && !this->checkParticlePopulation(Cmd)) return;
+
+    if (Cmd.Class == NetworkMessageClassificationType::CMD)
+        MSG_REPORT(Messages, "brk", std::string(Entry->Description)+" requested", MessageHandler::INFO);
+    else if (Entry->Name.substr(0, 3) == "sub")
+        MSG_REPORT(Messages, "brk", "Subscribe on "+std::string(Entry->Description)+" requested", MessageHandler::INFO);
+    else
+        MSG_REPORT(Messages, "brk", "Unsubscribe from "+std::string(Entry->Description)+" requested", MessageHandler::INFO);
+
+    if (Cmd.Method == NetworkMethodType::CMD_ACCELERATE_SIMULATION &&
+        (Cmd.Number > 1.0e6 || Cmd.Number < 0.1))
+    {
+        Cmd.Number = std::clamp(Cmd.Number, 0.1, 1.0e6);
+        Json_.createResult()
+            .beginObject()
+            .addNamedValue("success", true)
+            .addNamedValue("notification", "Out of bounds, valid interval is [0.1, 1.0e6]. Clamping value.")
+            .endObject()
+            .finalise(Cmd.RequestID);
+        this->send(Cmd.ClientID);
+    }
+    else if (Cmd.Class == NetworkMessageClassificationType::CMD &&
+             Entry->Route != NetworkRouteType::MAIN &&
+             Cmd.Method != NetworkMethodType::CMD_PARTICLE_POPULATION)
     {
-        ActionsNet_[c](_d);
-        this->sendSuccess(_d.ClientID, (*_d.Payload)["id"].GetUint());
+        // Commands are validated, so they are acknowledged before execution
+        this->sendSuccess(Cmd.ClientID, Cmd.RequestID);
     }
-    else
+
+    switch (Entry->Route)
     {
-        Messages.report("brk", "Unknown method "+std::string(c), MessageHandler::WARNING);
-        this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload));
+        case NetworkRouteType::MAIN:
+            DBLK(Messages.report("brk", "Processing message", MessageHandler::DEBUG_L3);)
+            this->executeMain(Cmd);
+            break;
+        case NetworkRouteType::NET:
+            DBLK(Messages.report("brk", "Appending request to network queue", MessageHandler::DEBUG_L1);)
+            QueueToNet_->enqueue(Cmd);
+            break;
+        case NetworkRouteType::SIM:
+            DBLK(Messages.report("brk", "Appending request to simulation queue", MessageHandler::DEBUG_L1);)
+            QueueToSim_->enqueue(Cmd);
+            break;
     }
 }
 
-void NetworkMessageBroker::executeSim(const NetworkMessageClassified& _d)
+bool NetworkMessageBroker::parse(NetworkMessage& _m, JsonDocumentType& _Doc)
 {
     auto& Messages = Reg_.ctx<MessageHandler>();
 
-    const auto c = JsonManager::getMethod(_d.Payload);
-    if (ActionsSim_.find(c) != ActionsSim_.end())
-    {
-        ActionsSim_[c](_d);
-    }
-    else
-    {
-        Messages.report("brk", "Unknown method "+std::string(c), MessageHandler::WARNING);
-        this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload));
+    DBLK(Messages.report("brk", "Parsing message", MessageHandler::DEBUG_L1);)
+
+    // Parse in-situ: strings of the document point into the payload buffer,
+    // which isn't needed otherwise
+    if (_Doc.ParseInsitu(&_m.Payload[0]).HasParseError())
+    {
+        MSG_REPORT(Messages, "brk", "Parse error from client "+std::to_string(entt::to_integral(_m.ClientID))+": "+
+                             GetParseError_En(_Doc.GetParseError()), MessageHandler::WARNING);
+        this->sendError(JsonManager::ErrorType::PARSE, _m.ClientID, 0);
+        return false;
     }
+    return true;
 }
 
-void NetworkMessageBroker::distribute(const NetworkMessageParsed& _d)
+bool NetworkMessageBroker::resolveStarSystem(NetworkCommand& _c)
 {
-    auto& Messages = Reg_.ctx<MessageHandler>();
-
-    const auto c = std::string(JsonManager::getMethod(_d.Payload));
-    const auto Prefix = c.substr(0,3);
+    auto Index = Reg_.ctx<SimulationManager>().getNameIndex();
 
-    NetworkMessageClassificationType ClassificationType{NetworkMessageClassificationType::CMD};
-    bool IsValidPrefixSuffix{false};
+    NameMatches_.clear();
+    if (Index != nullptr) Index->find(Text_, NAME_SEARCH_RESULTS_MAX, NameMatches_);
 
-    if (Prefix == "cmd")
+    const auto it = std::find_if(NameMatches_.begin(), NameMatches_.end(), [](const auto& _m){return _m.IsStarSystem;});
+    if (it == NameMatches_.end())
     {
-        IsValidPrefixSuffix = true;
+        this->sendError(JsonManager::ErrorType::PARAMS, _c.ClientID, _c.RequestID, "Unknown star system");
+        return false;
     }
-    else if (Prefix == "sub" || Prefix == "uns")
+
+    // Entity is passed to the simulation thread as number, the client gets
+    // it for mapping subsequent data
+    _c.Number = double(entt::to_integral(it->ID));
+    Json_.createResult()
+        .beginObject()
+        .addNamedValue("eid", entt::to_integral(it->ID))
+        .addNamedValue("name", it->Name)
+        .endObject()
+        .finalise(_c.RequestID);
+    this->send(_c.ClientID);
+    return true;
+}
+
+void NetworkMessageBroker::send(JsonManager::ClientIDType _ClientID)
+{
+    if (IsBatch_)
     {
-        auto p = c.find_last_of("_");
-        auto f = c.substr(p+1);
-        JsonManager::replaceMethod(_d.Payload, c.substr(0,p).c_str());
-        ClassificationType = to_enum(f);
-        if (ClassificationType != NetworkMessageClassificationType::INVALID)
-        {
-            IsValidPrefixSuffix = true;
-            DBLK(
-            {
-                Messages.report("brk", "Requested subscription frequency: "+f, MessageHandler::DEBUG_L1);
-            })
-        }
-        else
-        {
-            Messages.report("brk", "Unknown suffix for subscription frequency", MessageHandler::WARNING);
-            this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload));
-        }
+        if (BatchCount_++ > 0) BatchBuffer_ += ',';
+        BatchBuffer_ += Json_.getString();
     }
     else
     {
-        Messages.report("brk", "Unknown prefix or missing, should be <cmd_>/<sub_>/<uns_>", MessageHandler::WARNING);
-        this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload));
-    }
-    if (IsValidPrefixSuffix)
-    {
-        auto Method = JsonManager::getMethod(_d.Payload);
-        if (Domains_.find(Method) != Domains_.end())
-        {
-            Domains_[Method](_d, ClassificationType);
-        }
-        else
-        {
-            Messages.report("brk", "Unknown method "+std::string(Method), MessageHandler::WARNING);
-            this->sendError(JsonManager::ErrorType::METHOD, _d.ClientID, JsonManager::getID(_d.Payload));
-        }
+        QueueOut_->enqueue({_ClientID, Json_.getString()});
     }
 }
 
-NetworkMessageParsed NetworkMessageBroker::parse(const NetworkMessage& _m) const
+void NetworkMessageBroker::sendError(JsonManager::ClientIDType _ClientID, JsonManager::ParamCheckResult _r)
 {
-    auto& Messages = Reg_.ctx<MessageHandler>();
+    Json_.createError(_r.Error, _r.Explanation.c_str())
+        .finalise(_r.RequestID);
+    this->send(_ClientID);
+}
 
-    DBLK(Messages.report("brk", "Parsing message", MessageHandler::DEBUG_L1);)
+void NetworkMessageBroker::sendError(JsonManager::ErrorType _e, JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID, const char* _Data)
+{
+    Json_.createError(_e, _Data)
+        .finalise(_MessageID);
+    this->send(_ClientID);
+}
 
-    const auto d = std::make_shared<Document>();
+void NetworkMessageBroker::sendGalaxyChunk(const NetworkCommand& _c)
+{
+    auto& Chunks = Reg_.ctx<GalaxyChunkManager>();
+    if (!Chunks.isInitialised())
+    {
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Galaxy chunks not available yet");
+        return;
+    }
 
-    ParseResult r = d->Parse(_m.Payload.c_str());
-    if (!r)
+    constexpr double Limit = double(std::numeric_limits<std::int32_t>::max());
+    if (_c.Number != std::floor(_c.Number) || _c.Number2 != std::floor(_c.Number2) ||
+        std::abs(_c.Number) > Limit || std::abs(_c.Number2) > Limit)
     {
-        this->sendError(JsonManager::ErrorType::PARSE, _m.ClientID, JsonManager::getID(d));
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        this->sendError(JsonManager::ErrorType::PARAMS, _c.ClientID, _c.RequestID,
+                        "Invalid chunk, coordinates have to be 32 bit integers");
+        return;
     }
 
-    return {_m.ClientID, d};
-}
+    const auto Chunk = Chunks.get(std::int32_t(_c.Number), std::int32_t(_c.Number2));
 
-void NetworkMessageBroker::sendError(JsonManager::ClientIDType _ClientID, JsonManager::ParamCheckResult _r) const
-{
-    auto& Json = Reg_.ctx<JsonManager>();
-    Json.createError(_r.Error, _r.Explanation.c_str())
-        .finalise(_r.RequestID);
-    QueueOut_->enqueue({_ClientID, Json.getString()});
+    // Binary frames aren't part of batch responses, see sendGalaxyDensity
+    const auto t = Reg_.ctx<SimulationManager>().getSimSeconds();
+    QueueOut_->enqueue({_c.ClientID, Chunks.getFrame(*Chunk, _c.RequestID, t),
+                        NetworkTopicType::GALAXY_DATA, true});
 }
 
-void NetworkMessageBroker::sendError(JsonManager::ErrorType _e, JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID, const char* _Data) const
+void NetworkMessageBroker::sendGalaxyDensity(const NetworkCommand& _c)
 {
-    auto& Json = Reg_.ctx<JsonManager>();
-    Json.createError(_e, _Data)
-        .finalise(_MessageID);
-    QueueOut_->enqueue({_ClientID, Json.getString()});
+    auto Density = Reg_.ctx<SimulationManager>().getDensityPyramid();
+    if (Density == nullptr)
+    {
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Galaxy density not available yet");
+        return;
+    }
+    if (_c.Number < 0.0 || _c.Number >= DENSITY_PYRAMID_LEVELS || _c.Number != std::floor(_c.Number))
+    {
+        const auto Text = "Invalid level, valid levels are 0 (finest) to "+std::to_string(DENSITY_PYRAMID_LEVELS-1);
+        this->sendError(JsonManager::ErrorType::PARAMS, _c.ClientID, _c.RequestID, Text.c_str());
+        return;
+    }
+
+    // Binary frames aren't part of batch responses, they are sent directly.
+    // The request ID in the frame header maps it to the request.
+    QueueOut_->enqueue({_c.ClientID, Density->getFrame(std::uint32_t(_c.Number), _c.RequestID),
+                        NetworkTopicType::GALAXY_DENSITY, true});
 }
 
-void NetworkMessageBroker::sendSuccess(JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID) const
+void NetworkMessageBroker::sendNameMatches(const NetworkCommand& _c)
 {
-    auto& Json = Reg_.ctx<JsonManager>();
-    Json.createResult(true)
-        .finalise(_MessageID);
-    QueueOut_->enqueue({_ClientID, Json.getString()});
+    TRACE_ZONE("broker_name_lookup");
+
+    // Index is immutable, hence, it is queried directly by the main thread
+    auto Index = Reg_.ctx<SimulationManager>().getNameIndex();
+    if (Index == nullptr)
+    {
+        this->sendError(JsonManager::ErrorType::METHOD, _c.ClientID, _c.RequestID, "Names not indexed yet");
+        return;
+    }
+
+    NameMatches_.clear();
+    switch (_c.Method)
+    {
+        case NetworkMethodType::CMD_FIND_NAME:
+            Index->find(Text_, NAME_SEARCH_RESULTS_MAX, NameMatches_);
+            break;
+        case NetworkMethodType::CMD_SEARCH_NAME:
+            Index->findPrefix(Text_, NAME_SEARCH_RESULTS_MAX, NameMatches_);
+            break;
+        case NetworkMethodType::CMD_SEARCH_NAME_FUZZY:
+            // Short names would match almost anything with larger distances
+            Index->findFuzzy(Text_, Text_.size() < 8 ? 1 : 2, NAME_SEARCH_RESULTS_MAX, NameMatches_);
+            break;
+        default:
+            break;
+    }
+
+    Json_.createResult()
+        .beginArray();
+    for (const auto& m : NameMatches_)
+    {
+        Json_.beginObject()
+            .addNamedValue("eid", entt::to_integral(m.ID))
+            .addNamedValue("name", m.Name)
+            .addNamedValue("d", m.Distance)
+            .endObject();
+    }
+    Json_.endArray()
+        .finalise(_c.RequestID);
+    this->send(_c.ClientID);
 }
 
-NetworkMessageClassificationType NetworkMessageBroker::to_enum(const std::string& _s)
+void NetworkMessageBroker::sendSuccess(JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID)
 {
-    auto it = SubscriptionTypeMap.find(_s);
-    if (it != SubscriptionTypeMap.end()) return it->second;
-    else return NetworkMessageClassificationType::INVALID;
+    Json_.createResult(true)
+        .finalise(_MessageID);
+    this->send(_ClientID);
 }
@@ -1,14 +1,15 @@
 #ifndef NETWORK_MESSAGE_BROKER_HPP
 #define NETWORK_MESSAGE_BROKER_HPP
 
-#include <functional>
 #include <string>
-#include <unordered_map>
-// #include <unordered_set>
+#include <vector>
 
 #include <concurrentqueue/concurrentqueue.h>
 #include <entt/entity/registry.hpp>
+#include "json_document_pool.hpp"
 #include "json_manager.hpp"
+#include "name_index.hpp"
+#include "network_command.hpp"
 #include "network_message.hpp"
 
 class NetworkMessageBroker
@@ -17,77 +18,116 @@ class NetworkMessageBroker
     public:
 
         explicit NetworkMessageBroker(entt::registry& _Reg,
-                                      moodycamel::ConcurrentQueue<NetworkMessageClassified>* _QueueToSim,
-                                      moodycamel::ConcurrentQueue<NetworkMessageParsed>* _QueueToNet,
+                                      entt::registry& _RegClients,
+                                      moodycamel::ConcurrentQueue<NetworkCommand>* _QueueToSim,
+                                      moodycamel::ConcurrentQueue<NetworkCommand>* _QueueToNet,
                                       moodycamel::ConcurrentQueue<NetworkMessage>* _QueueOut);
 
-        void process(const NetworkMessage& _m);
-        void executeNet(const NetworkMessageParsed& _d);
-        void executeSim(const NetworkMessageClassified& _d);
+        void process(NetworkMessage& _m);
+        void executeNet(const NetworkCommand& _c);
+        void executeSim(const NetworkCommand& _c);
 
     private:
 
+        bool checkParticlePopulation(const NetworkCommand& _c);
+        bool decode(const NetworkMessageParsed& _d, NetworkCommand& _c, const NetworkMethodEntry*& _Entry);
         void distribute(const NetworkMessageParsed& _d);
-        NetworkMessageParsed parse(const NetworkMessage& _m) const;
+        void executeMain(const NetworkCommand& _c);
+        bool parse(NetworkMessage& _m, JsonDocumentType& _Doc);
+        bool resolveStarSystem(NetworkCommand& _c);
+        void processBatch(JsonManager::ClientIDType _ClientID, const rapidjson::Value& _Batch);
+        void processRequest(const NetworkMessageParsed& _d);
+        void send(JsonManager::ClientIDType _ClientID);
         void sendError(JsonManager::ErrorType _e, JsonManager::ClientIDType _ClientID,
-                       JsonManager::RequestIDType _MessageID, const char* _Data = "") const;
-        void sendError(JsonManager::ClientIDType _ClientID, JsonManager::ParamCheckResult _r) const;
-        void sendSuccess(JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID) const;
-
-        void distributeCommand(const NetworkMessageParsed _m, NetworkMessageClassificationType _c, const std::string& _s);
-        void sub(const NetworkMessageParsed _m, NetworkMessageClassificationType _c, const std::string& _s);
-        void unsub(const NetworkMessageParsed _m, NetworkMessageClassificationType _c, const std::string& _s);
+                       JsonManager::RequestIDType _MessageID, const char* _Data = "");
+        void sendError(JsonManager::ClientIDType _ClientID, JsonManager::ParamCheckResult _r);
+        void sendGalaxyChunk(const NetworkCommand& _c);
+        void sendGalaxyDensity(const NetworkCommand& _c);
+        void sendNameMatches(const NetworkCommand& _c);
+        void sendSuccess(JsonManager::ClientIDType _ClientID, JsonManager::RequestIDType _MessageID);
+
+        template<class T01, class T05, class T1, class T5, class T10>
+        void subscribe(const NetworkCommand& _c);
+        template<class T01, class T05, class T1, class T5, class T10>
+        void unsubscribe(const NetworkCommand& _c);
 
         entt::registry&  Reg_;
+        entt::registry&  RegClients_;
 
-        std::unordered_map<std::string, std::function<void(const NetworkMessageParsed&, NetworkMessageClassificationType)>> Domains_;
-        std::unordered_map<std::string, std::function<void(const NetworkMessageParsed&)>> ActionsMain_;
-        std::unordered_map<std::string, std::function<void(const NetworkMessageParsed&)>> ActionsNet_;
-        std::unordered_map<std::string, std::function<void(const NetworkMessageClassified&)>> ActionsSim_;
+        // Responses are created by the broker (main thread) only. Hence, it
+        // uses its own JSON manager, the one in registry's context is used
+        // by the simulation thread
+        JsonManager Json_;
 
-        moodycamel::ConcurrentQueue<NetworkMessageClassified>* QueueToSim_{nullptr};
-        moodycamel::ConcurrentQueue<NetworkMessageParsed>* QueueToNet_{nullptr};
-        moodycamel::ConcurrentQueue<NetworkMessage>* QueueOut_{nullptr};
+        // Recycled documents for parsing of incoming messages
+        JsonDocumentPool DocumentPool_;
 
-        // Helpers, to handle string to enum conversion
-        NetworkMessageClassificationType to_enum(const std::string& _s);
+        // String parameter of the command being decoded, strings don't
+        // cross the queues
+        std::string Text_;
+        std::vector<NameIndex::Match> NameMatches_;
 
-        const std::unordered_map<std::string, NetworkMessageClassificationType> SubscriptionTypeMap
-        {
-            {"evt", NetworkMessageClassificationType::EVT},
-            {"s01", NetworkMessageClassificationType::S01},
-            {"s05", NetworkMessageClassificationType::S05},
-            {"s1", NetworkMessageClassificationType::S1},
-            {"s5", NetworkMessageClassificationType::S5},
-            {"s10", NetworkMessageClassificationType::S10}
-        };
+        // Responses to JSON-RPC batch requests are collected and sent as
+        // one array
+        bool        IsBatch_{false};
+        std::size_t BatchCount_{0};
+        std::string BatchBuffer_;
 
-};
+        moodycamel::ConcurrentQueue<NetworkCommand>* QueueToSim_{nullptr};
+        moodycamel::ConcurrentQueue<NetworkCommand>* QueueToNet_{nullptr};
+        moodycamel::ConcurrentQueue<NetworkMessage>* QueueOut_{nullptr};
 
-inline void NetworkMessageBroker::distributeCommand(const NetworkMessageParsed _m, NetworkMessageClassificationType _c, const std::string& _s)
-{
-    auto& Messages = Reg_.ctx<MessageHandler>();
-    Messages.report("brk", _s+" requested", MessageHandler::INFO);
-    DBLK(Messages.report("brk", "Appending request to simulation queue", MessageHandler::DEBUG_L1);)
-    QueueToSim_->enqueue({_m.ClientID, _c, _m.Payload});
-}
+};
 
-inline void NetworkMessageBroker::sub(const NetworkMessageParsed _m, NetworkMessageClassificationType _c,
-                                      const std::string& _s)
+template<class T01, class T05, class T1, class T5, class T10>
+inline void NetworkMessageBroker::subscribe(const NetworkCommand& _c)
 {
-    auto& Messages = Reg_.ctx<MessageHandler>();
-    Messages.report("brk", "Subscribe on " + _s + " requested", MessageHandler::INFO);
-    DBLK(Messages.report("brk", "Appending request to simulation queue", MessageHandler::DEBUG_L1);)
-    QueueToSim_->enqueue({_m.ClientID, _c, _m.Payload});
+    // Classification was validated by the broker before
+    switch (_c.Class)
+    {
+        case NetworkMessageClassificationType::S01:
+            RegClients_.emplace_or_replace<T01>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S05:
+            RegClients_.emplace_or_replace<T05>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S1:
+            RegClients_.emplace_or_replace<T1>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S5:
+            RegClients_.emplace_or_replace<T5>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S10:
+            RegClients_.emplace_or_replace<T10>(_c.ClientID);
+            break;
+        default:
+            break;
+    }
 }
 
-inline void NetworkMessageBroker::unsub(const NetworkMessageParsed _m, NetworkMessageClassificationType _c,
-                                        const std::string& _s)
+template<class T01, class T05, class T1, class T5, class T10>
+inline void NetworkMessageBroker::unsubscribe(const NetworkCommand& _c)
 {
-    auto& Messages = Reg_.ctx<MessageHandler>();
-    Messages.report("brk", "Unsubscribe from " + _s + " requested", MessageHandler::INFO);
-    DBLK(Messages.report("brk", "Appending request to simulation queue", MessageHandler::DEBUG_L1);)
-    QueueToSim_->enqueue({_m.ClientID, _c, _m.Payload});
+    switch (_c.Class)
+    {
+        case NetworkMessageClassificationType::S01:
+            RegClients_.remove<T01>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S05:
+            RegClients_.remove<T05>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S1:
+            RegClients_.remove<T1>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S5:
+            RegClients_.remove<T5>(_c.ClientID);
+            break;
+        case NetworkMessageClassificationType::S10:
+            RegClients_.remove<T10>(_c.ClientID);
+            break;
+        default:
+            break;
+    }
 }
 
 #endif // NETWORK_MESSAGE_BROKER_HPP
@@ -0,0 +1,110 @@
+#include "publisher_manager.hpp"
+
+#include "message_handler.hpp"
+#include "trace.hpp"
+
+PublisherManager::~PublisherManager()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        IsStopped_ = true;
+    }
+    Condition_.notify_one();
+    if (Thread_.joinable()) Thread_.join();
+}
+
+void PublisherManager::init(moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue)
+{
+    OutputQueue_ = _OutputQueue;
+
+    Thread_ = std::thread(&PublisherManager::run, this);
+    Reg_.ctx<MessageHandler>().report("sim", "Publisher thread started successfully", MessageHandler::INFO);
+}
+
+void PublisherManager::publish()
+{
+    States_.publish();
+    {
+        std::lock_guard<std::mutex> Lock(Lock_);
+        IsPublished_ = true;
+    }
+    Condition_.notify_one();
+}
+
+void PublisherManager::encode(const WorldState& _s)
+{
+    TRACE_ZONE("publisher_encode");
+
+    Messages_.clear();
+
+    for (const auto& b : _s.Bodies)
+    {
+        Json_.createNotification("bc_dynamic_data")
+            .addParam("eid", entt::to_integral(b.ID))
+            .addParam("ts", _s.TimeStamp)
+            .addParam("ts_r", _s.TimeStampReal)
+            .addParam("name", b.Name)
+            .addParam("m", b.m)
+            .addParam("i", b.i)
+            .addParam("r", b.r)
+            .addParam("spx", b.spx)
+            .addParam("spy", b.spy)
+            .addParam("px", b.px)
+            .addParam("py", b.py)
+            .finalise();
+        Messages_.emplace_back(Json_.getString(), NetworkTopicType::DYNAMIC_DATA);
+    }
+
+    for (const auto& t : _s.Tires)
+    {
+        Json_.createNotification("tire_data")
+            .addParam("eid", entt::to_integral(t.ID))
+            .addParam("ts", _s.TimeStamp)
+            .addParam("ts_r", _s.TimeStampReal)
+            .beginArray("rim_xy")
+            .addValue(t.RimX)
+            .addValue(t.RimY)
+            .endArray()
+            .addParam("rim_r", t.RimR)
+            .beginArray("rubber");
+
+        for (auto r : t.Rubber)
+        {
+            Json_.addValue(r);
+        }
+
+        Json_.endArray()
+            .finalise();
+        Messages_.emplace_back(Json_.getString(), NetworkTopicType::TIRE_DATA);
+    }
+}
+
+void PublisherManager::run()
+{
+    TRACE_THREAD("publisher");
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> Lock(Lock_);
+            Condition_.wait(Lock, [this]{return IsPublished_ || IsStopped_;});
+            if (IsStopped_) break;
+            IsPublished_ = false;
+        }
+        if (!States_.update()) continue;
+
+        const auto& State = States_.getReadBuffer();
+        if (State.Clients.empty()) continue;
+
+        this->encode(State);
+
+        TRACE_ZONE("publisher_queue");
+        for (auto c : State.Clients)
+        {
+            for (const auto& m : Messages_)
+            {
+                OutputQueue_->enqueue({c, m.first, m.second});
+            }
+        }
+    }
+}
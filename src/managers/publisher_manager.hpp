@@ -0,0 +1,65 @@
+#ifndef PUBLISHER_MANAGER_HPP
+#define PUBLISHER_MANAGER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <concurrentqueue/concurrentqueue.h>
+#include <entt/entity/registry.hpp>
+
+#include "json_manager.hpp"
+#include "network_message.hpp"
+#include "triple_buffer.hpp"
+#include "world_state.hpp"
+
+// Encodes and queues the per-tick dynamic data broadcast on its own thread,
+// so the number of subscribed clients doesn't eat into physics time. The
+// simulation thread publishes a world state per tick via a triple buffer,
+// hence, it never waits for the publisher. A slow publisher skips ticks
+// instead of delaying the simulation.
+// Each message is encoded once per tick and shared by all subscribed
+// clients.
+class PublisherManager
+{
+
+    public:
+
+        explicit PublisherManager(entt::registry& _Reg) : Reg_(_Reg), Json_(_Reg) {}
+        ~PublisherManager();
+        PublisherManager(const PublisherManager&) = delete;
+        PublisherManager& operator=(const PublisherManager&) = delete;
+
+        void init(moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue);
+
+        // Simulation thread
+        WorldState& getWorldState() {return States_.getWriteBuffer();}
+        void publish();
+
+    private:
+
+        void encode(const WorldState& _s);
+        void run();
+
+        entt::registry& Reg_;
+
+        // Publisher thread uses its own JSON manager, the one in registry's
+        // context is used by the simulation thread
+        JsonManager Json_;
+        std::vector<std::pair<std::string, NetworkTopicType>> Messages_;
+
+        TripleBuffer<WorldState> States_;
+
+        moodycamel::ConcurrentQueue<NetworkMessage>* OutputQueue_{nullptr};
+
+        std::mutex              Lock_;
+        std::condition_variable Condition_;
+        bool                    IsPublished_{false};
+        bool                    IsStopped_{false};
+        std::thread             Thread_;
+
+};
+
+#endif // PUBLISHER_MANAGER_HPP
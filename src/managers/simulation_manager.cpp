@@ -1,18 +1,26 @@
 #include "simulation_manager.hpp"
 
+#include <cstring>
 #include <random>
 
+#include <entt/entity/snapshot.hpp>
 #include <rapidjson/document.h>
 
+#include "checkpoint_manager.hpp"
+
 #include "message_handler.hpp"
+#include "metrics_manager.hpp"
+#include "publisher_manager.hpp"
 
 #include "acceleration_component.hpp"
 #include "body_component.hpp"
+#include "command_buffer.hpp"
 #include "name_component.hpp"
 #include "network_message_broker.hpp"
 #include "position_component.hpp"
 #include "radius_component.hpp"
 #include "star_definitions.hpp"
+#include "trace.hpp"
 #include "sim_components.hpp"
 #include "subscription_components.hpp"
 #include "velocity_component.hpp"
@@ -20,16 +28,15 @@
 
 SimulationManager::~SimulationManager()
 {
-    if (Thread_.joinable()) Thread_.join();
+    this->join();
+}
 
-    if (World_ != nullptr)
-    {
-        delete World_;
-        World_ = nullptr;
-    }
+void SimulationManager::join()
+{
+    if (Thread_.joinable()) Thread_.join();
 }
 
-void SimulationManager::init(moodycamel::ConcurrentQueue<NetworkMessageClassified>* const _QueueSimIn,
+void SimulationManager::init(moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueSimIn,
                              moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue)
 {
     auto& Messages = Reg_.ctx<MessageHandler>();
@@ -39,55 +46,52 @@ void SimulationManager::init(moodycamel::ConcurrentQueue<NetworkMessageClassifie
     QueueSimIn_ = _QueueSimIn;
     OutputQueue_ = _OutputQueue;
 
-    World_ = new b2World({0.0f, -9.81f});
-
-    this->createTire();
-
     auto GroupAV = Reg_.group<AccelerationComponent>(entt::get<VelocityComponent>);
     auto GroupVP = Reg_.group<VelocityComponent,PositionComponent>();
     auto GroupVPAB = Reg_.group<VelocityComponent,PositionComponent>(
                                 entt::get<AccelerationComponent, BodyComponent>);
 
-    Vec2Dd SolarSystemPosition{0.0, 6.0e21};
+    auto& Checkpoints = Reg_.ctx<CheckpointManager>();
+    std::vector<char> Checkpoint;
+    if (Checkpoints.isRestoreRequested() && Checkpoints.load(Checkpoint) && this->restoreCheckpoint(Checkpoint))
+    {
+        Messages.report("sim", "Checkpoint of tick "+std::to_string(Tick_)+" restored", MessageHandler::INFO);
+    }
+    else
+    {
+        if (Checkpoints.isRestoreRequested())
+            Messages.report("sim", "Restoring checkpoint failed, creating new world", MessageHandler::WARNING);
 
-    auto Earth = Reg_.create();
-    Reg_.emplace<SystemPositionComponent>(Earth, SolarSystemPosition);
-    Reg_.emplace<PositionComponent>(Earth, Vec2Dd{0.0, -152.1e9});
-    Reg_.emplace<VelocityComponent>(Earth, Vec2Dd{29.29e3, 0.0});
-    Reg_.emplace<AccelerationComponent>(Earth, Vec2Dd{0.0, 0.0});
-    Reg_.emplace<BodyComponent>(Earth, 5.972e24, 8.008e37);
-    Reg_.emplace<RadiusComponent>(Earth, 6378137.0);
-    SysName_.setName(Earth, "Earth");
+        this->createTire();
+        this->createSolarSystem();
+        this->generateGalaxy();
+    }
 
-    auto Moon = Reg_.create();
-    Reg_.emplace<SystemPositionComponent>(Moon, SolarSystemPosition);
-    Reg_.emplace<PositionComponent>(Moon, Vec2Dd{384400.0e3, -152.1e9});
-    Reg_.emplace<VelocityComponent>(Moon, Vec2Dd{29.29e3, 964.0});
-    Reg_.emplace<AccelerationComponent>(Moon, Vec2Dd{0.0, 0.0});
-    Reg_.emplace<BodyComponent>(Moon, 7.346e22, 1.0);
-    Reg_.emplace<RadiusComponent>(Moon, 1737.0e3);
-    SysName_.setName(Moon, "Moon");
+    // Built in the background, while the remaining structures are built
+    Field_.build(Stars_);
 
-    auto Sun = Reg_.create();
-    Reg_.emplace<SystemPositionComponent>(Sun, SolarSystemPosition);
-    Reg_.emplace<PositionComponent>(Sun, Vec2Dd{0.0, 0.0});
-    Reg_.emplace<VelocityComponent>(Sun, Vec2Dd{0.0, 0.0});
-    Reg_.emplace<AccelerationComponent>(Sun, Vec2Dd{0.0, 0.0});
-    Reg_.emplace<BodyComponent>(Sun, 1.9884e30, 1.0);
-    Reg_.emplace<StarDataComponent>(Sun, SpectralClassE::G, 5778.0);
-    Reg_.emplace<RadiusComponent>(Sun, 6.96342e8);
-    SysName_.setName(Sun, "Sun");
+    this->scheduleSystems();
+    SysName_.publish();
+    SysOrder_.sort();
 
-    std::mt19937 Generator;
-    std::uniform_int_distribution Seeds;
-    auto SolarSystem = Reg_.create();
-    auto& SolarSystemComponent = Reg_.emplace<StarSystemComponent>(SolarSystem);
-    SolarSystemComponent.Objects = {Sun, Earth, Moon};
-    SolarSystemComponent.Seed = Seeds(Generator);
-    SysName_.setName(SolarSystem, "Solar System");
+    {
+        TRACE_ZONE("density_pyramid");
+        Density_ = std::make_shared<const DensityPyramid>(Stars_);
+    }
+    // Stars move in the field of the galaxy. The field, hence, the rotation
+    // curve only depends on the star table, so it's the same after
+    // restoring a checkpoint.
+    Rotation_ = GalacticRotation(*Field_.wait(), Stars_);
 
-    this->generateGalaxy();
+    auto* InputLog = Reg_.try_ctx<InputLogWriter>();
+    if (InputLog != nullptr)
+    {
+        InputLog->begin(Seed_, SimStepSize_);
+        Messages.report("sim", "Recording input with seed "+std::to_string(Seed_), MessageHandler::INFO);
+    }
 
+    // Set before starting thread, main loop might check before first tick
+    IsRunning_ = true;
     Thread_ = std::thread(&SimulationManager::run, this);
     Messages.report("sim", "Simulation thread started successfully", MessageHandler::INFO);
 
@@ -133,79 +137,312 @@ std::uint64_t SimulationManager::getTimeStamp() const
     return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
-void SimulationManager::queueDynamicData(entt::entity _ClientID) const
+void SimulationManager::publishWorldState()
 {
-    auto& Json = Reg_.ctx<JsonManager>();
+    auto& Publisher = Reg_.ctx<PublisherManager>();
+    auto& State = Publisher.getWorldState();
 
+    State.Clients.clear();
+    RegClients_.view<DynamicDataSubscriptionComponent>().each(
+        [&State](auto _e)
+        {
+            State.Clients.push_back(_e);
+        });
+    if (State.Clients.empty()) return;
+
+    State.Tick = Tick_;
+    State.TimeStamp = SimTime_.toStamp();
+    State.TimeStampReal = this->getTimeStamp();
+
+    // Systems move with the rotation of the galaxy
+    const auto t = SimTime_.getTotalSeconds();
+
+    State.Bodies.clear();
     Reg_.view<BodyComponent,
-              NameComponent,
               PositionComponent,
               RadiusComponent,
               SystemPositionComponent>().each
-        ([&](auto _e, const auto& _b, const auto& _n, const auto& _p,
-                      const auto& _r, const auto& _s)
+        ([this, &State, t](auto _e, const auto& _b, const auto& _p,
+                                    const auto& _r, const auto& _s)
         {
-            Json.createNotification("bc_dynamic_data")
-                .addParam("eid", entt::to_integral(_e))
-                .addParam("ts", SimTime_.toStamp())
-                .addParam("ts_r", this->getTimeStamp())
-                .addParam("name", _n.Name)
-                .addParam("m", _b.m)
-                .addParam("i", _b.i)
-                .addParam("r", _r.r)
-                .addParam("spx", _s.v(0))
-                .addParam("spy", _s.v(1))
-                .addParam("px", _p.v(0))
-                .addParam("py", _p.v(1))
-                .finalise();
-            OutputQueue_->enqueue({_ClientID, Json.getString()});
+            auto& b = State.Bodies.emplace_back();
+            b.ID = _e;
+            SysName_.getName(_e, b.Name);
+            b.m = _b.m;
+            b.i = _b.i;
+            b.r = _r.r;
+            const auto sp = Rotation_.getPosition(_s.v, t);
+            b.spx = sp(0);
+            b.spy = sp(1);
+            b.px = _p.v(0);
+            b.py = _p.v(1);
+        });
+
+    State.Tires.clear();
+    Reg_.view<TireComponent>().each
+        ([&State](auto _e, const auto& _t)
+        {
+            auto& t = State.Tires.emplace_back();
+            t.ID = _e;
+            t.RimX = _t.Rim->GetWorldCenter().x;
+            t.RimY = _t.Rim->GetWorldCenter().y;
+            t.RimR = _t.Rim->GetFixtureList()->GetShape()->m_radius;
+            for (auto i=0u; i<_t.Rubber.size(); ++i)
+            {
+                t.Rubber[2*i] = _t.Rubber[i]->GetWorldCenter().x;
+                t.Rubber[2*i+1] = _t.Rubber[i]->GetWorldCenter().y;
+            }
         });
+
+    Publisher.publish();
 }
 
 void SimulationManager::queueGalaxyData(entt::entity _ClientID, JsonManager::RequestIDType _ReqID) const
 {
+    TRACE_ZONE("queue_galaxy_data");
+
     auto& Json = Reg_.ctx<JsonManager>();
 
+    char Name[NAME_SIZE_MAX];
+
+    // Positions at current time, evaluated for all stars at once
+    std::vector<double> X(Stars_.size());
+    std::vector<double> Y(Stars_.size());
+    Rotation_.getPositions(Stars_.size(), Stars_.getXs(), Stars_.getYs(), SimTime_.getTotalSeconds(),
+                           X.data(), Y.data());
+
     // Queue stars of the galaxy
-    Reg_.view<SystemPositionComponent,
-              BodyComponent,
-              RadiusComponent,
-              StarDataComponent,
-              NameComponent>().each
-        ([&](auto _e, const auto& _p, const auto& _b, const auto& _r, const auto& _s, const auto& _n)
-        {
-            Json.createNotification("galaxy_data_stars")
-                .addParam("eid", entt::to_integral(_e))
-                .addParam("ts", SimTime_.toStamp())
-                .addParam("ts_r", this->getTimeStamp())
-                .addParam("name", _n.Name)
-                .addParam("m", _b.m)
-                .addParam("i", _b.i)
-                .addParam("r", _r.r)
-                .addParam("sc", std::uint32_t(_s.SpectralClass))
-                .addParam("t", _s.Temperature)
-                .addParam("spx", _p.v(0))
-                .addParam("spy", _p.v(1))
-                .finalise();
-            OutputQueue_->enqueue({_ClientID, Json.getString()});
-        });
+    for (auto i=0u; i<Stars_.size(); ++i)
+    {
+        const auto e = Stars_.getID(i);
+        SysName_.getName(e, Name);
+        Json.createNotification("galaxy_data_stars")
+            .addParam("eid", entt::to_integral(e))
+            .addParam("ts", SimTime_.toStamp())
+            .addParam("ts_r", this->getTimeStamp())
+            .addParam("name", Name)
+            .addParam("m", double(Stars_.getMass(i)))
+            .addParam("i", 1.0)
+            .addParam("r", double(Stars_.getRadius(i)))
+            .addParam("sc", std::uint32_t(Stars_.getSpectralClass(i)))
+            .addParam("t", double(Stars_.getTemperature(i)))
+            .addParam("spx", X[i])
+            .addParam("spy", Y[i])
+            .finalise();
+        OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::GALAXY_DATA});
+    }
 
     // Queue star systems
-    Reg_.view<NameComponent, StarSystemComponent>().each
-        ([&](auto _e, const auto& _n, const auto& _s)
+    Reg_.view<StarSystemComponent>().each
+        ([&](auto _e, const auto&)
         {
+            SysName_.getName(_e, Name);
             Json.createNotification("galaxy_data_systems")
                 .addParam("eid", entt::to_integral(_e))
                 .addParam("ts", SimTime_.toStamp())
                 .addParam("ts_r", this->getTimeStamp())
-                .addParam("name", _n.Name)
+                .addParam("name", Name)
                 .finalise();
-            OutputQueue_->enqueue({_ClientID, Json.getString()});
+            OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::GALAXY_DATA});
         });
 
     Json.createResult("success")
         .finalise(_ReqID);
-    OutputQueue_->enqueue({_ClientID, Json.getString()});
+    OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::GALAXY_DATA});
+}
+
+void SimulationManager::captureCheckpoint(std::vector<char>& _Buffer) const
+{
+    CheckpointOutputArchive Archive(_Buffer);
+
+    Archive(Tick_);
+    Archive(Seed_);
+    Archive(SimTime_.getYears());
+    Archive(SimTime_.getSeconds());
+    Archive(SimTime_.getAcceleration());
+    Archive(SimTime_.isActive());
+    Archive(IsSimRunning_.load());
+
+    // Tire is not part of the snapshot, since it references box2d bodies,
+    // it is recreated on restore
+    entt::snapshot{Reg_}
+        .entities(Archive)
+        .component<AccelerationComponent, BodyComponent, GravitatorComponent, NameComponent,
+                   ParticlePopulationComponent, PendingBeltComponent, PositionComponent, ProceduralNameComponent,
+                   RadiusComponent, StarSystemComponent, SystemPositionComponent, VelocityComponent>(Archive);
+    Stars_.save(Archive);
+
+    // Worlds and their bodies are stored in creation and list order, which
+    // is the same after recreation
+    Archive(std::uint32_t(LocalWorlds_.getNumberOfWorlds()));
+    LocalWorlds_.each(
+        [&Archive](auto, const b2World& _World)
+        {
+            Archive(std::uint32_t(_World.GetBodyCount()));
+            for (const auto* b = _World.GetBodyList(); b != nullptr; b = b->GetNext())
+            {
+                Archive(b->GetTransform());
+                Archive(b->GetLinearVelocity());
+                Archive(b->GetAngularVelocity());
+                Archive(b->IsAwake());
+            }
+        });
+}
+
+bool SimulationManager::restoreCheckpoint(const std::vector<char>& _Buffer)
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    CheckpointInputArchive Archive(_Buffer);
+
+    std::uint32_t Years{0};
+    double Seconds{0.0};
+    double Acceleration{1.0};
+    bool IsActive{false};
+    bool IsSimRunning{false};
+    Archive(Tick_);
+    Archive(Seed_);
+    Archive(Years);
+    Archive(Seconds);
+    Archive(Acceleration);
+    Archive(IsActive);
+    Archive(IsSimRunning);
+
+    // Registry has to be empty for loading a snapshot as a whole
+    entt::snapshot_loader{Reg_}
+        .entities(Archive)
+        .component<AccelerationComponent, BodyComponent, GravitatorComponent, NameComponent,
+                   ParticlePopulationComponent, PendingBeltComponent, PositionComponent, ProceduralNameComponent,
+                   RadiusComponent, StarSystemComponent, SystemPositionComponent, VelocityComponent>(Archive)
+        .orphans();
+    Stars_.load(Archive);
+
+    if (!Archive.isValid())
+    {
+        Reg_.clear();
+        Stars_.clear();
+        Tick_ = 0;
+        IsSimRunning_ = false;
+        return false;
+    }
+
+    IsSimRunning_ = IsSimRunning;
+    SimTime_.set(Years, Seconds, IsActive);
+    SimTime_.setAcceleration(Acceleration);
+
+    // Name index isn't part of the snapshot
+    SysName_.invalidate();
+
+    this->createTire();
+
+    std::uint32_t NumberOfWorlds{0};
+    Archive(NumberOfWorlds);
+    if (NumberOfWorlds != std::uint32_t(LocalWorlds_.getNumberOfWorlds()))
+    {
+        Messages.report("sim", "Number of local worlds differs from checkpoint, keeping initial state",
+                        MessageHandler::WARNING);
+        return true;
+    }
+    bool IsMatching{true};
+    LocalWorlds_.each(
+        [&](auto, b2World& _World)
+        {
+            std::uint32_t NumberOfBodies{0};
+            Archive(NumberOfBodies);
+            if (!IsMatching || NumberOfBodies != std::uint32_t(_World.GetBodyCount()))
+            {
+                IsMatching = false;
+                return;
+            }
+            for (auto* b = _World.GetBodyList(); b != nullptr; b = b->GetNext())
+            {
+                b2Transform Transform;
+                b2Vec2 Velocity;
+                float AngularVelocity{0.0f};
+                bool IsAwake{true};
+                Archive(Transform);
+                Archive(Velocity);
+                Archive(AngularVelocity);
+                Archive(IsAwake);
+                b->SetTransform(Transform.p, Transform.q.GetAngle());
+                b->SetLinearVelocity(Velocity);
+                b->SetAngularVelocity(AngularVelocity);
+                b->SetAwake(IsAwake);
+            }
+        });
+    if (!IsMatching)
+    {
+        Messages.report("sim", "Number of box2d bodies differs from checkpoint, keeping initial state",
+                        MessageHandler::WARNING);
+    }
+    return true;
+}
+
+void SimulationManager::createSolarSystem()
+{
+    Vec2Dd SolarSystemPosition{0.0, 6.0e21};
+
+    auto Earth = Reg_.create();
+    Reg_.emplace<SystemPositionComponent>(Earth, SolarSystemPosition);
+    Reg_.emplace<PositionComponent>(Earth, Vec2Dd{0.0, -152.1e9});
+    Reg_.emplace<VelocityComponent>(Earth, Vec2Dd{29.29e3, 0.0});
+    Reg_.emplace<AccelerationComponent>(Earth, Vec2Dd{0.0, 0.0});
+    Reg_.emplace<BodyComponent>(Earth, 5.972e24, 8.008e37);
+    Reg_.emplace<GravitatorComponent>(Earth);
+    Reg_.emplace<RadiusComponent>(Earth, 6378137.0);
+    SysName_.setName(Earth, "Earth");
+
+    auto Moon = Reg_.create();
+    Reg_.emplace<SystemPositionComponent>(Moon, SolarSystemPosition);
+    Reg_.emplace<PositionComponent>(Moon, Vec2Dd{384400.0e3, -152.1e9});
+    Reg_.emplace<VelocityComponent>(Moon, Vec2Dd{29.29e3, 964.0});
+    Reg_.emplace<AccelerationComponent>(Moon, Vec2Dd{0.0, 0.0});
+    Reg_.emplace<BodyComponent>(Moon, 7.346e22, 1.0);
+    Reg_.emplace<GravitatorComponent>(Moon);
+    Reg_.emplace<RadiusComponent>(Moon, 1737.0e3);
+    SysName_.setName(Moon, "Moon");
+
+    auto Sun = Reg_.create();
+    Reg_.emplace<SystemPositionComponent>(Sun, SolarSystemPosition);
+    Reg_.emplace<PositionComponent>(Sun, Vec2Dd{0.0, 0.0});
+    Reg_.emplace<VelocityComponent>(Sun, Vec2Dd{0.0, 0.0});
+    Reg_.emplace<AccelerationComponent>(Sun, Vec2Dd{0.0, 0.0});
+    Reg_.emplace<BodyComponent>(Sun, 1.9884e30, 1.0);
+    Reg_.emplace<GravitatorComponent>(Sun);
+    Reg_.emplace<RadiusComponent>(Sun, 6.96342e8);
+    Stars_.add(Sun, SolarSystemPosition, 1.9884e30, 6.96342e8, SpectralClassE::G, 5778.0);
+    SysName_.setName(Sun, "Sun");
+
+    std::mt19937 Generator(Seed_);
+    std::uniform_int_distribution Seeds;
+    auto SolarSystem = Reg_.create();
+    auto& SolarSystemComponent = Reg_.emplace<StarSystemComponent>(SolarSystem);
+    SolarSystemComponent.Objects = {Sun, Earth, Moon};
+    SolarSystemComponent.Seed = Seeds(Generator);
+    SysName_.setName(SolarSystem, "Solar System");
+
+    // Main asteroid belt
+    auto& Belt = Reg_.emplace<ParticlePopulationComponent>(SolarSystem);
+    Belt.Particles.addBelt(std::uint32_t(SolarSystemComponent.Seed), PARTICLES_PER_SOLAR_SYSTEM_BELT,
+                           Vec2Dd{0.0, 0.0}, Vec2Dd{0.0, 0.0}, 1.9884e30, 2.2*AU, 3.3*AU);
+}
+
+void SimulationManager::createBelt(entt::entity _System, std::uint32_t _Star)
+{
+    // Belts are placed around the frost line, which scales with the square
+    // root of luminosity
+    const double r = Stars_.getRadius(_Star) / SOLAR_RADIUS;
+    const double t = Stars_.getTemperature(_Star) / SOLAR_TEMPERATURE;
+    const auto Scale = r * t*t;
+
+    // Only parameters, particles are materialised when first requested.
+    // They are drawn by their own generator, seeded by the system.
+    auto& Belt = Reg_.emplace<PendingBeltComponent>(_System);
+    Belt.CentralMass = Stars_.getMass(_Star);
+    Belt.Particles = PARTICLES_PER_GENERATED_BELT;
+    Belt.Seed = std::uint32_t(Reg_.get<StarSystemComponent>(_System).Seed);
+    Belt.RadiusMin = 2.2*AU*Scale;
+    Belt.RadiusMax = 3.3*AU*Scale;
 }
 
 void SimulationManager::generateGalaxy()
@@ -214,7 +451,7 @@ void SimulationManager::generateGalaxy()
 
     // std::random_device r;
     // std::default_random_engine Generator(r());
-    std::mt19937 Generator;
+    std::mt19937 Generator(Seed_);
 
     std::uniform_int_distribution Seeds;
     std::normal_distribution<double> DistGalaxyArmScatter(0.0, 1.0);
@@ -243,7 +480,7 @@ void SimulationManager::generateGalaxy()
     DBLK(Messages.report("sim", "Creating spiral arms", MessageHandler::DEBUG_L1);)
     DBLK(Messages.report("sim", "Distribution of spectral classes (0-6 = M-O):", MessageHandler::DEBUG_L3);)
 
-    int c{0};
+    std::uint32_t c{0};
     for (auto i=0; i<Arms; ++i)
     {
         double ScatterArm = GalaxyScatterBase + DistGalaxyArmScatterDeviation(Generator);
@@ -257,10 +494,10 @@ void SimulationManager::generateGalaxy()
             auto e = Reg_.create();
 
             auto e_s = Reg_.create();
-            auto SystemComponent = Reg_.emplace<StarSystemComponent>(e_s);
+            auto& SystemComponent = Reg_.emplace<StarSystemComponent>(e_s);
             SystemComponent.Objects = {e};
             SystemComponent.Seed = Seeds(Generator);
-            SysName_.setName(e_s, "System_"+std::to_string(c));
+            SysName_.setProceduralName(e_s, ProceduralNameType::SYSTEM, c);
 
             double r=Alpha/Phi;
             double p = Phi+2.0*MATH_PI/Arms*i;
@@ -271,12 +508,14 @@ void SimulationManager::generateGalaxy()
             if (SpectralClass > 6) SpectralClass = 6;
             DBLK(Messages.reportRaw(std::to_string(SpectralClass)+" ", MessageHandler::DEBUG_L3);)
 
-            Reg_.emplace<SystemPositionComponent>(e, Vec2Dd{r*std::cos(p)+DistGalaxyArmScatter(Generator)*r*ScatterArm,
-                                                            r*std::sin(p)+DistGalaxyArmScatter(Generator)*r*ScatterArm});
-            Reg_.emplace<BodyComponent>(e, StarMassDistribution[SpectralClass](Generator), 1.0);
-            Reg_.emplace<StarDataComponent>(e, SpectralClassE(SpectralClass), StarTemperatureDistribution[SpectralClass](Generator));
-            Reg_.emplace<RadiusComponent>(e, StarRadiusDistribution[SpectralClass](Generator));
-            SysName_.setName(e, "Star_"+std::to_string(c));
+            // Drawn in this order to keep galaxies of a seed unchanged
+            Vec2Dd Position{r*std::cos(p)+DistGalaxyArmScatter(Generator)*r*ScatterArm,
+                            r*std::sin(p)+DistGalaxyArmScatter(Generator)*r*ScatterArm};
+            double Mass = StarMassDistribution[SpectralClass](Generator);
+            double Temperature = StarTemperatureDistribution[SpectralClass](Generator);
+            double Radius = StarRadiusDistribution[SpectralClass](Generator);
+            this->createBelt(e_s, Stars_.add(e, Position, Mass, Radius, SpectralClassE(SpectralClass), Temperature));
+            SysName_.setProceduralName(e, ProceduralNameType::STAR, c);
             ++c;
         }
         DBLK(Messages.reportRaw("\n", MessageHandler::DEBUG_L3);)
@@ -288,10 +527,10 @@ void SimulationManager::generateGalaxy()
         auto e = Reg_.create();
 
         auto e_s = Reg_.create();
-        auto SystemComponent = Reg_.emplace<StarSystemComponent>(e_s);
+        auto& SystemComponent = Reg_.emplace<StarSystemComponent>(e_s);
         SystemComponent.Objects = {e};
         SystemComponent.Seed = Seeds(Generator);
-        SysName_.setName(e_s, "System_"+std::to_string(c));
+        SysName_.setProceduralName(e_s, ProceduralNameType::SYSTEM, c);
 
         double r=std::abs(DistGalaxyCenter(Generator));
 
@@ -301,11 +540,12 @@ void SimulationManager::generateGalaxy()
         if (SpectralClass > 6) SpectralClass = 6;
         DBLK(Messages.reportRaw(std::to_string(SpectralClass)+" ", MessageHandler::DEBUG_L3);)
 
-        Reg_.emplace<SystemPositionComponent>(e, 0.5e22*r*Vec2Dd{std::cos(Phi),std::sin(Phi)});
-        Reg_.emplace<BodyComponent>(e, StarMassDistribution[SpectralClass](Generator), 1.0);
-        Reg_.emplace<StarDataComponent>(e, SpectralClassE(SpectralClass), StarTemperatureDistribution[SpectralClass](Generator));
-        Reg_.emplace<RadiusComponent>(e, StarRadiusDistribution[SpectralClass](Generator));
-        SysName_.setName(e, "Star_"+std::to_string(c));
+        Vec2Dd Position = 0.5e22*r*Vec2Dd{std::cos(Phi),std::sin(Phi)};
+        double Mass = StarMassDistribution[SpectralClass](Generator);
+        double Temperature = StarTemperatureDistribution[SpectralClass](Generator);
+        double Radius = StarRadiusDistribution[SpectralClass](Generator);
+        this->createBelt(e_s, Stars_.add(e, Position, Mass, Radius, SpectralClassE(SpectralClass), Temperature));
+        SysName_.setProceduralName(e, ProceduralNameType::STAR, c);
         ++c;
     }
     DBLK(Messages.reportRaw("\n", MessageHandler::DEBUG_L3);)
@@ -313,106 +553,152 @@ void SimulationManager::generateGalaxy()
     Messages.report("sim", std::to_string(c) + " star systems generated", MessageHandler::INFO);
 }
 
-void SimulationManager::processSubscriptions(Timer& _t)
+void SimulationManager::processSubscriptions()
 {
-    static Timer Counter01;
-    static Timer Counter05;
-    static Timer Counter1;
-    static Timer Counter5;
-    static Timer Counter10;
-    if (Counter01.split() >= 0.1)
+    if (this->isDue(100))
     {
-        Reg_.view<PerformanceStatsSubscriptionTag01>().each(
+        RegClients_.view<PerformanceStatsSubscriptionTag01>().each(
             [this](auto _e)
             {
-                this->queuePerformanceStats(_e);
+                this->queuePerformanceStats(_e, TickStatsWindowType::S01);
             });
-        Reg_.view<SimStatsSubscriptionTag01>().each(
+        Stats_.reset(TickStatsWindowType::S01);
+        RegClients_.view<SimStatsSubscriptionTag01>().each(
             [this](auto _e)
             {
                 this->queueSimStats(_e);
             });
-        Counter01.restart();
     }
-    if (Counter05.split() >= 0.5)
+    if (this->isDue(500))
     {
-        Reg_.view<PerformanceStatsSubscriptionTag05>().each(
+        RegClients_.view<PerformanceStatsSubscriptionTag05>().each(
             [this](auto _e)
             {
-                this->queuePerformanceStats(_e);
+                this->queuePerformanceStats(_e, TickStatsWindowType::S05);
             });
-        Reg_.view<SimStatsSubscriptionTag05>().each(
+        Stats_.reset(TickStatsWindowType::S05);
+        RegClients_.view<SimStatsSubscriptionTag05>().each(
             [this](auto _e)
             {
                 this->queueSimStats(_e);
             });
-        Counter05.restart();
     }
-    if (Counter1.split() >= 1.0)
+    if (this->isDue(1000))
     {
-        Reg_.view<PerformanceStatsSubscriptionTag1>().each(
+        RegClients_.view<PerformanceStatsSubscriptionTag1>().each(
             [this](auto _e)
             {
-                this->queuePerformanceStats(_e);
+                this->queuePerformanceStats(_e, TickStatsWindowType::S1);
             });
-        Reg_.view<SimStatsSubscriptionTag1>().each(
+        Stats_.reset(TickStatsWindowType::S1);
+        RegClients_.view<SimStatsSubscriptionTag1>().each(
             [this](auto _e)
             {
                 this->queueSimStats(_e);
             });
-        Counter1.restart();
     }
-    if (Counter5.split() >= 5.0)
+    if (this->isDue(5000))
     {
-        Reg_.view<PerformanceStatsSubscriptionTag5>().each(
+        RegClients_.view<PerformanceStatsSubscriptionTag5>().each(
             [this](auto _e)
             {
-                this->queuePerformanceStats(_e);
+                this->queuePerformanceStats(_e, TickStatsWindowType::S5);
             });
-        Reg_.view<SimStatsSubscriptionTag5>().each(
+        Stats_.reset(TickStatsWindowType::S5);
+        RegClients_.view<SimStatsSubscriptionTag5>().each(
             [this](auto _e)
             {
                 this->queueSimStats(_e);
             });
-        Counter5.restart();
     }
-    if (Counter10.split() >= 10.0)
+    if (this->isDue(10000))
     {
-        Reg_.view<PerformanceStatsSubscriptionTag10>().each(
+        RegClients_.view<PerformanceStatsSubscriptionTag10>().each(
             [this](auto _e)
             {
-                this->queuePerformanceStats(_e);
+                this->queuePerformanceStats(_e, TickStatsWindowType::S10);
             });
-        Reg_.view<SimStatsSubscriptionTag10>().each(
+        Stats_.reset(TickStatsWindowType::S10);
+        RegClients_.view<SimStatsSubscriptionTag10>().each(
             [this](auto _e)
             {
                 this->queueSimStats(_e);
             });
-        Counter10.restart();
     }
-    Reg_.view<GalaxyDataSubscriptionComponent>().each(
+    RegClients_.view<GalaxyDataSubscriptionComponent>().each(
         [this](auto _e, auto& _t)
         {
             if (!_t.Transmitted)
             {
-                this->queueGalaxyData(_e, 7);
+                this->queueGalaxyData(_e, _t.RequestID);
                 _t.Transmitted = true;
             }
         });
 }
 
-void SimulationManager::queuePerformanceStats(entt::entity _ClientID) const
+void SimulationManager::queueParticlePopulation(entt::entity _ClientID, JsonManager::RequestIDType _ReqID,
+                                                entt::entity _System, std::uint32_t _Cells)
+{
+    TRACE_ZONE("queue_particle_population");
+
+    if (!Reg_.valid(_System) ||
+        !(Reg_.has<ParticlePopulationComponent>(_System) || Reg_.has<PendingBeltComponent>(_System)))
+    {
+        auto& Json = Reg_.ctx<JsonManager>();
+        Json.createError(JsonManager::ErrorType::PARAMS, "No particle population in star system")
+            .finalise(_ReqID);
+        OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::PARTICLE_DATA});
+        return;
+    }
+
+    // Orbits are uniform in phase, hence, a belt materialised now looks
+    // like one evolved since generation
+    if (const auto* Belt = Reg_.try_get<PendingBeltComponent>(_System); Belt != nullptr)
+    {
+        auto& Population = Reg_.emplace<ParticlePopulationComponent>(_System);
+        Population.CentralMass = Belt->CentralMass;
+        Population.Particles.addBelt(Belt->Seed, Belt->Particles, Vec2Dd{0.0, 0.0}, Vec2Dd{0.0, 0.0},
+                                     Belt->CentralMass, Belt->RadiusMin, Belt->RadiusMax);
+        Reg_.remove<PendingBeltComponent>(_System);
+    }
+    const auto& Population = Reg_.get<ParticlePopulationComponent>(_System);
+
+    if (_Cells == 0)
+        OutputQueue_->enqueue({_ClientID, Population.Particles.getFrame(_System, _ReqID),
+                               NetworkTopicType::PARTICLE_DATA, true});
+    else
+        OutputQueue_->enqueue({_ClientID, Population.Particles.getDensityFrame(_System, _ReqID, _Cells),
+                               NetworkTopicType::PARTICLE_DATA, true});
+}
+
+void SimulationManager::queuePerformanceStats(entt::entity _ClientID, TickStatsWindowType _w) const
 {
+    TRACE_ZONE("queue_perf_stats");
+
     auto& Json = Reg_.ctx<JsonManager>();
 
+    // Last samples
     Json.createNotification("perf_stats")
         .addParam("t_sim", SimulationTime_)
         .addParam("t_phy", PhysicsTimer_.elapsed())
         .addParam("t_queue_in", QueueInTimer_.elapsed())
-        .addParam("t_queue_out", QueueOutTime_)
+        .addParam("t_queue_out", QueueOutTime_);
+
+    // Distribution since last report of this frequency
+    for (auto i=0u; i<std::size_t(TickPhaseType::COUNT); ++i)
+    {
+        const auto& h = Stats_.get(_w, TickPhaseType(i));
+        const auto& Keys = TICK_PHASE_STATS_KEYS[i];
+        Json.addParam(Keys[0], h.getPercentile(0.5))
+            .addParam(Keys[1], h.getPercentile(0.99))
+            .addParam(Keys[2], h.getPercentile(0.999))
+            .addParam(Keys[3], h.getMax());
+    }
+    Json.addParam("n_ticks", std::uint64_t(Stats_.get(_w, TickPhaseType::TICK).getCount()))
+        .addParam("n_overruns", std::uint64_t(Stats_.getOverruns(_w)))
         .finalise();
 
-    OutputQueue_->enqueue({_ClientID, Json.getString()});
+    OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::PERF_STATS});
 }
 
 void SimulationManager::queueSimStats(entt::entity _ClientID) const
@@ -422,42 +708,10 @@ void SimulationManager::queueSimStats(entt::entity _ClientID) const
     Json.createNotification("sim_stats")
         .addParam("ts", SimTime_.toStamp())
         .addParam("ts_f", SimTime_.getAcceleration())
-        .addParam("stat_sim", IsSimRunning_)
+        .addParam("stat_sim", IsSimRunning_.load())
         .finalise();
 
-    OutputQueue_->enqueue({_ClientID, Json.getString()});
-}
-
-void SimulationManager::queueTireData(entt::entity _ClientID) const
-{
-    auto& Json = Reg_.ctx<JsonManager>();
-
-    Reg_.view<TireComponent>().each
-        ([&](auto _e, const auto& _t)
-        {
-            Json.createNotification("tire_data")
-                .addParam("eid", entt::to_integral(_e))
-                .addParam("ts", SimTime_.toStamp())
-                .addParam("ts_r", this->getTimeStamp())
-                .beginArray("rim_xy")
-                .addValue(_t.Rim->GetWorldCenter().x)
-                .addValue(_t.Rim->GetWorldCenter().y)
-                .endArray()
-                .addParam("rim_r", _t.Rim->GetFixtureList()->GetShape()->m_radius)
-                .beginArray("rubber");
-
-            for (auto r : _t.Rubber)
-            {
-                Json.addValue(r->GetWorldCenter().x)
-                    .addValue(r->GetWorldCenter().y);
-            }
-
-            Json.endArray()
-                .finalise();
-
-            OutputQueue_->enqueue({_ClientID, Json.getString()});
-        });
-
+    OutputQueue_->enqueue({_ClientID, Json.getString(), NetworkTopicType::SIM_STATS});
 }
 
 void SimulationManager::run()
@@ -466,71 +720,232 @@ void SimulationManager::run()
 
     auto& Messages = Reg_.ctx<MessageHandler>();
     auto& Broker = Reg_.ctx<NetworkMessageBroker>();
+    auto& Metrics = Reg_.ctx<MetricsManager>();
+
+    // Input is either recorded or replayed, the latter without network
+    // and as fast as possible
+    auto* InputLog = Reg_.try_ctx<InputLogWriter>();
+    auto* InputReplay = Reg_.try_ctx<InputLogReader>();
+    auto& Checkpoints = Reg_.ctx<CheckpointManager>();
 
     Messages.report("sim", "Simulation Manager running", MessageHandler::INFO);
+    TRACE_THREAD("sim");
 
-    Timer TimerSubscriptions;
-    TimerSubscriptions.start();
+    Timer ReplayTimer;
+    ReplayTimer.start();
 
-    IsRunning_ = true;
     while (IsRunning_)
     {
         SimulationTimer_.start();
 
-        NetworkMessageClassified d;
+        NetworkCommand Cmd;
+
+        TRACE_ZONE_NAMED(TickZone, "sim_tick");
 
         QueueInTimer_.start();
-        while (QueueSimIn_->try_dequeue(d))
+        TRACE_ZONE_NAMED(QueueInZone, "queue_in");
+        // Structural changes are only applied at this point of the tick.
+        // Clients first, since queued requests might refer to new clients
+        if (InputLog != nullptr) InputLog->setTick(Tick_);
+        RegClients_.ctx<CommandBuffer>().apply();
+        if (InputReplay != nullptr) this->replayInput(*InputReplay);
+        while (QueueSimIn_->try_dequeue(Cmd))
         {
-            Broker.executeSim(d);
+            if (InputLog != nullptr) InputLog->recordCommand(Cmd);
+            Broker.executeSim(Cmd);
         }
+        Reg_.ctx<CommandBuffer>().apply();
+        SysName_.publish();
+        // Structural changes break the order of kinematic pools. Restore it
+        // at most once per second, gravity falls back to lookups meanwhile.
+        if (!SysOrder_.isOrdered() && this->isDue(1000))
+        {
+            TRACE_ZONE("kinematic_order");
+            SysOrder_.sort();
+        }
+        TRACE_ZONE_END(QueueInZone);
         QueueInTimer_.stop();
+        Stats_.record(TickPhaseType::QUEUE_IN, QueueInTimer_.elapsed());
+
+        Timer PhaseTimer;
 
+        // Systems run concurrently as far as their data access allows
         PhysicsTimer_.start();
         if (IsSimRunning_)
         {
-            World_->Step(SimStepSize_*1.0e-3, 8, 3);
-            SysGravity_.calculateForces();
-            SysIntegrator_.integrate(SimStepSize_*1.0e-3*SimTime_.getAcceleration());
-            SimTime_.inc(SimStepSize_*1.0e-3);
+            Scheduler_.run();
+            Scheduler_.record(Stats_);
         }
         PhysicsTimer_.stop();
+        SimSeconds_.store(SimTime_.getTotalSeconds(), std::memory_order_relaxed);
 
         QueueOutTimer_.start();
 
-        this->processSubscriptions(TimerSubscriptions);
+        PhaseTimer.start();
+        {
+            TRACE_ZONE("subscriptions");
+            this->processSubscriptions();
+        }
+        PhaseTimer.stop();
+        Stats_.record(TickPhaseType::SUBSCRIPTIONS, PhaseTimer.elapsed());
 
-        Reg_.view<DynamicDataSubscriptionComponent>().each(
-            [this](auto _e)
-            {
-                this->queueDynamicData(_e);
-                this->queueTireData(_e);
-            }
-        );
+        // Only a copy of the state is taken, encoding is done by the
+        // publisher thread while the next tick is running
+        PhaseTimer.start();
+        {
+            TRACE_ZONE("serialisation");
+            this->publishWorldState();
+        }
+        PhaseTimer.stop();
+        Stats_.record(TickPhaseType::SERIALISATION, PhaseTimer.elapsed());
 
         QueueOutTimer_.stop();
         QueueOutTime_ = QueueOutTimer_.elapsed();
 
+        // Only the state is copied, compression and writing is done by
+        // the checkpoint thread
+        if (Checkpoints.isDue(Tick_, SimStepSize_))
+        {
+            TRACE_ZONE("checkpoint_capture");
+            auto* Buffer = Checkpoints.acquire();
+            if (Buffer != nullptr)
+            {
+                this->captureCheckpoint(*Buffer);
+                Checkpoints.submit(Tick_);
+            }
+        }
+
         SimulationTimer_.stop();
         SimulationTime_ = SimulationTimer_.elapsed();
+        Stats_.record(TickPhaseType::TICK, SimulationTime_);
+
+        Metrics.setEntityCounts(Reg_.alive(),
+                                Stars_.size(),
+                                Reg_.view<StarSystemComponent>().size(),
+                                RegClients_.alive());
+        Metrics.setLocalWorldCounts(LocalWorlds_.getNumberOfWorlds(),
+                                    LocalWorlds_.getNumberOfAwakeWorlds());
+        TRACE_ZONE_END(TickZone);
+        ++Tick_;
         if (SimStepSize_ - SimulationTimer_.elapsed_ms() > 0.0)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(SimStepSize_ - int(SimulationTimer_.elapsed_ms())));
+            if (InputReplay == nullptr)
+                std::this_thread::sleep_for(std::chrono::milliseconds(SimStepSize_ - int(SimulationTimer_.elapsed_ms())));
         }
         else
         {
-            Messages.report("sim", "Thread processing exceeds step time ("
-                            + std::to_string(SimulationTimer_.elapsed_ms())+"/"
-                            + std::to_string(SimStepSize_)+")ms",
-                            MessageHandler::WARNING);
+            Stats_.recordOverrun();
+            MSG_REPORT(Messages, "sim", "Thread processing exceeds step time ("
+                                 + std::to_string(SimulationTimer_.elapsed_ms())+"/"
+                                 + std::to_string(SimStepSize_)+")ms",
+                                 MessageHandler::WARNING);
         }
     }
 
+    // Final checkpoint, written and reported before this thread ends, since
+    // main destroys the message handler right after joining it
+    if (Checkpoints.isEnabled())
+    {
+        Checkpoints.wait();
+        this->captureCheckpoint(*Checkpoints.acquire());
+        Checkpoints.submit(Tick_);
+        Checkpoints.wait();
+    }
+
+    if (InputLog != nullptr)
+    {
+        InputLog->setTick(Tick_);
+        InputLog->end();
+        Messages.report("sim", "Input recorded, "+std::to_string(InputLog->getNumberOfRecords())+
+                        " records in "+std::to_string(Tick_)+" ticks", MessageHandler::INFO);
+    }
+    if (InputReplay != nullptr)
+    {
+        ReplayTimer.stop();
+        this->reportReplay(ReplayTimer.elapsed());
+    }
+
     Messages.report("sim", "Simulation thread stopped successfully", MessageHandler::INFO);
 }
 
+void SimulationManager::replayInput(InputLogReader& _Log)
+{
+    auto& Broker = Reg_.ctx<NetworkMessageBroker>();
+
+    InputLogRecord r;
+    while (_Log.next(Tick_, r))
+    {
+        switch (r.Type)
+        {
+            case InputLogRecordType::CONNECT:
+                static_cast<void>(RegClients_.create(r.Command.ClientID));
+                break;
+            case InputLogRecordType::DISCONNECT:
+                if (RegClients_.valid(r.Command.ClientID)) RegClients_.destroy(r.Command.ClientID);
+                break;
+            case InputLogRecordType::COMMAND:
+                Broker.executeSim(r.Command);
+                break;
+            default:
+                break;
+        }
+    }
+    if (_Log.isFinished()) IsRunning_ = false;
+}
+
+void SimulationManager::reportReplay(double _Seconds) const
+{
+    auto& Messages = Reg_.ctx<MessageHandler>();
+
+    Messages.report("sim", "Replay finished, "+std::to_string(Tick_)+" ticks in "+
+                    std::to_string(_Seconds)+"s ("+std::to_string(Tick_/_Seconds)+" ticks/s), "+
+                    std::to_string(Stats_.getOverruns(TickStatsWindowType::TOTAL))+" overruns",
+                    MessageHandler::INFO);
+    for (auto i=0u; i<std::size_t(TickPhaseType::COUNT); ++i)
+    {
+        const auto& h = Stats_.get(TickStatsWindowType::TOTAL, TickPhaseType(i));
+        Messages.report("sim", std::string(TICK_PHASE_NAMES[i])+
+                        ": p50="+std::to_string(h.getPercentile(0.5)*1.0e3)+
+                        "ms p99="+std::to_string(h.getPercentile(0.99)*1.0e3)+
+                        "ms max="+std::to_string(h.getMax()*1.0e3)+"ms", MessageHandler::INFO);
+    }
+}
+
+void SimulationManager::scheduleSystems()
+{
+    // Local physics is only relevant if observed, see README
+    Scheduler_.add("box2d", [this]{LocalWorlds_.step(SimStepSize_*1.0e-3f, Jobs_);})
+        .runsIf([this]{return !RegClients_.view<DynamicDataSubscriptionComponent>().empty();})
+        .writes<LocalWorldComponent, TireComponent>()
+        .records(TickPhaseType::BOX2D);
+
+    Scheduler_.add("gravity", [this]{SysGravity_.calculateForces(SysOrder_.isOrdered());})
+        .reads<BodyComponent, GravitatorComponent, PositionComponent, StarSystemComponent>()
+        .writes<AccelerationComponent>()
+        .records(TickPhaseType::GRAVITY);
+
+    Scheduler_.add("integration",
+                   [this]
+                   {
+                       SysIntegrator_.integrate(SimStepSize_*1.0e-3*SimTime_.getAcceleration());
+                       SimTime_.inc(SimStepSize_*1.0e-3);
+                   })
+        .reads<AccelerationComponent>()
+        .writes<PositionComponent, VelocityComponent, SimTimer>()
+        .records(TickPhaseType::INTEGRATION);
+
+    Scheduler_.add("particles", [this]{SysParticles_.integrate(SimStepSize_*1.0e-3*SimTime_.getAcceleration());})
+        .reads<BodyComponent, GravitatorComponent, PositionComponent, SimTimer, StarSystemComponent>()
+        .writes<ParticlePopulationComponent>()
+        .records(TickPhaseType::PARTICLES);
+}
+
 void SimulationManager::createTire()
 {
+    // The tire is its own region for now, parent of its local world
+    auto e = Reg_.create();
+    auto* World = LocalWorlds_.create(e, {0.0f, -9.81f});
+
     b2BodyDef myBodyDef;
     myBodyDef.type = b2_staticBody; //change body type
     myBodyDef.position.Set(0,-0.5); //middle, bottom
@@ -542,13 +957,12 @@ void SimulationManager::createTire()
     myFixtureDef.density = 1.0f;
     // myFixtureDef.restitution = 1.0f;
     myFixtureDef.shape = &polygonShape;
-    b2Body* staticBody = World_->CreateBody(&myBodyDef);
+    b2Body* staticBody = World->CreateBody(&myBodyDef);
     staticBody->CreateFixture(&myFixtureDef); //add a fixture to the body
 
     float p_x{0.0f};
     float p_y{0.5f};
 
-    auto e = Reg_.create();
     auto& Tire = Reg_.emplace<TireComponent>(e);
 
     b2BodyDef BodyDefRim;
@@ -562,7 +976,7 @@ void SimulationManager::createTire()
     FixtureDefRim.density = 80.0;
     FixtureDefRim.shape = &ShapeCircleRim;
 
-    Tire.Rim = World_->CreateBody(&BodyDefRim);
+    Tire.Rim = World->CreateBody(&BodyDefRim);
     Tire.Rim->CreateFixture(&FixtureDefRim);
 
     for (auto i=0u; i<TireComponent::SEGMENTS; ++i)
@@ -594,7 +1008,7 @@ void SimulationManager::createTire()
         FixtureDefTire.shape = &ShapeCircleTire;
 
         // Create body and attach shape
-        Tire.Rubber[i] = World_->CreateBody(&BodyDefTire);
+        Tire.Rubber[i] = World->CreateBody(&BodyDefTire);
         Tire.Rubber[i]->CreateFixture(&FixtureDefTire);
 
         b2MassData MassData;
@@ -609,7 +1023,7 @@ void SimulationManager::createTire()
         JointDefRadial.collideConnected = true;
         b2LinearStiffness(JointDefRadial.stiffness, JointDefRadial.damping, 0.1f, 0.1f, Tire.Rim, Tire.Rubber[i]);
 
-        Tire.RadialJoints[i] = static_cast<b2DistanceJoint*>(World_->CreateJoint(&JointDefRadial));
+        Tire.RadialJoints[i] = static_cast<b2DistanceJoint*>(World->CreateJoint(&JointDefRadial));
         Tire.RadialJoints[i]->SetMinLength(0.35f);
         // Tire.RadialJoints[i]->SetMaxLength(0.45f);
         // Tire.RadialJoints[i]->SetLength(0.4f);
@@ -622,7 +1036,7 @@ void SimulationManager::createTire()
             JointDefTangential.collideConnected = true;
             b2LinearStiffness(JointDefTangential.stiffness, JointDefTangential.damping, 0.1f, 0.1f, Tire.Rubber[i], Tire.Rubber[i-1]);
 
-            Tire.TangentialJoints[i] = static_cast<b2DistanceJoint*>(World_->CreateJoint(&JointDefTangential));
+            Tire.TangentialJoints[i] = static_cast<b2DistanceJoint*>(World->CreateJoint(&JointDefTangential));
             // Tire.TangentialJoints[i]->SetMinLength(0.01f);
         }
     }
@@ -632,7 +1046,7 @@ void SimulationManager::createTire()
     JointDefTangential.collideConnected = true;
     b2LinearStiffness(JointDefTangential.stiffness, JointDefTangential.damping, 0.1f, 0.1f, Tire.Rubber[0], Tire.Rubber[TireComponent::SEGMENTS]);
 
-    Tire.TangentialJoints[TireComponent::SEGMENTS-1] = static_cast<b2DistanceJoint*>(World_->CreateJoint(&JointDefTangential));
+    Tire.TangentialJoints[TireComponent::SEGMENTS-1] = static_cast<b2DistanceJoint*>(World->CreateJoint(&JointDefTangential));
     // Tire.TangentialJoints[TireComponent::SEGMENTS-1]->SetMinLength(0.01f);
 
     b2MassData MassData;
@@ -1,65 +1,140 @@
 #ifndef SIMULATION_MANAGER_HPP
 #define SIMULATION_MANAGER_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <random>
 #include <thread>
+#include <vector>
 
 #include <box2d/box2d.h>
 #include <concurrentqueue/concurrentqueue.h>
 #include <entt/entity/registry.hpp>
 
+#include "density_pyramid.hpp"
+#include "galactic_field_manager.hpp"
+#include "galactic_rotation.hpp"
 #include "json_manager.hpp"
 #include "gravity_system.hpp"
+#include "input_log.hpp"
 #include "integrator_system.hpp"
+#include "job_pool.hpp"
+#include "kinematic_order_system.hpp"
+#include "local_world_manager.hpp"
 #include "name_system.hpp"
+#include "network_command.hpp"
 #include "network_message.hpp"
+#include "particle_system.hpp"
 #include "sim_timer.hpp"
+#include "star_table.hpp"
+#include "system_scheduler.hpp"
+#include "tick_stats.hpp"
 #include "timer.hpp"
 
+// Astronomical unit in m
+constexpr double AU{1.495978707e11};
+
+// Particles of asteroid belts. Belts of generated systems are materialised
+// when requested, hence, only observed systems cost memory and time.
+constexpr std::uint32_t PARTICLES_PER_GENERATED_BELT = 1024;
+constexpr std::uint32_t PARTICLES_PER_SOLAR_SYSTEM_BELT = 100000;
+
 class SimulationManager
 {
 
     public:
 
-        explicit SimulationManager(entt::registry& _Reg) : Reg_(_Reg),
-                                                           SysGravity_(_Reg),
-                                                           SysIntegrator_(_Reg),
-                                                           SysName_(_Reg){}
+        explicit SimulationManager(entt::registry& _Reg,
+                                   entt::registry& _RegClients) : Reg_(_Reg),
+                                                                  RegClients_(_RegClients),
+                                                                  SysGravity_(_Reg),
+                                                                  SysIntegrator_(_Reg),
+                                                                  SysOrder_(_Reg),
+                                                                  SysName_(_Reg),
+                                                                  SysParticles_(_Reg),
+                                                                  LocalWorlds_(_Reg),
+                                                                  Scheduler_(Jobs_),
+                                                                  Field_(_Reg){}
         ~SimulationManager();
 
         bool isRunning() const {return IsRunning_;}
-
-        void init(moodycamel::ConcurrentQueue<NetworkMessageClassified>* const _QueueSimIn,
+        std::uint32_t getSeed() const {return Seed_;}
+        std::uint64_t getTick() const {return Tick_;}
+        // Any thread, updated each tick
+        double getSimSeconds() const {return SimSeconds_.load(std::memory_order_relaxed);}
+        const TickStats& getTickStats() const {return Stats_;}
+        std::shared_ptr<const NameIndex> getNameIndex() const {return SysName_.getIndex();}
+        // Built by init(), read-only afterwards
+        const GalacticRotation& getRotation() const {return Rotation_;}
+        std::shared_ptr<const DensityPyramid> getDensityPyramid() const {return Density_;}
+
+        void init(moodycamel::ConcurrentQueue<NetworkCommand>* const _QueueSimIn,
                   moodycamel::ConcurrentQueue<NetworkMessage>* const _OutputQueue);
         void start();
         void stop();
         void shutdown();
+        // Waits until the simulation thread finished its final checkpoint
+        // and reports, must be called before context variables it uses are
+        // destroyed
+        void join();
 
+        void resetPerfStats() {Stats_.reset();}
         void setAccel(double _a) {SimTime_.setAcceleration(_a);}
+        void setSeed(std::uint32_t _Seed) {Seed_ = _Seed;}
+        void setStepSize(std::uint32_t _StepSize) {SimStepSize_ = _StepSize;}
+
+        // Particles of the system's belts and rings, or their density on
+        // _Cells x _Cells cells if non-zero, sent as binary frame.
+        // Simulation thread, materialises pending belts.
+        void queueParticlePopulation(entt::entity _ClientID, JsonManager::RequestIDType _ReqID,
+                                     entt::entity _System, std::uint32_t _Cells);
+
+        // Public for benchmarking, called by init() and run()
+        void captureCheckpoint(std::vector<char>& _Buffer) const;
+        void generateGalaxy();
 
 
     private:
 
         std::uint64_t getTimeStamp() const;
 
-        void generateGalaxy();
-        void processSubscriptions(Timer& _t);
-        void queueDynamicData(entt::entity _ClientID) const;
+        // Periods in ms, counted in ticks for deterministic replay
+        bool isDue(std::uint32_t _Period) const {return Tick_ % std::max(_Period/SimStepSize_, 1u) == 0;}
+        void processSubscriptions();
+        void publishWorldState();
         void queueGalaxyData(entt::entity _ClientID, JsonManager::RequestIDType _ReqID) const;
-        void queuePerformanceStats(entt::entity _ClientID) const;
+        void queuePerformanceStats(entt::entity _ClientID, TickStatsWindowType _w) const;
         void queueSimStats(entt::entity _ClientID) const;
-        void queueTireData(entt::entity _ClientID) const;
+        void replayInput(InputLogReader& _Log);
+        bool restoreCheckpoint(const std::vector<char>& _Buffer);
+        void reportReplay(double _Seconds) const;
         void run();
+        void scheduleSystems();
 
+        void createBelt(entt::entity _System, std::uint32_t _Star);
+        void createSolarSystem();
         void createTire();
 
-        entt::registry&  Reg_;
+        entt::registry&  Reg_;          // World: bodies, stars, systems
+        entt::registry&  RegClients_;   // Clients and their subscriptions
         GravitySystem    SysGravity_;
         IntegratorSystem SysIntegrator_;
+        KinematicOrderSystem SysOrder_;
         NameSystem       SysName_;
+        ParticleSystem   SysParticles_;
+
+        JobPool           Jobs_;
+        LocalWorldManager LocalWorlds_;
+        SystemScheduler   Scheduler_;
+
+        StarTable Stars_;   // Static data of stars, read-only after generation
+        std::shared_ptr<const DensityPyramid> Density_;
+        GalacticRotation Rotation_;
+        GalacticFieldManager Field_;
 
-        moodycamel::ConcurrentQueue<NetworkMessageClassified>* QueueSimIn_{nullptr};
+        moodycamel::ConcurrentQueue<NetworkCommand>* QueueSimIn_{nullptr};
         moodycamel::ConcurrentQueue<NetworkMessage>* OutputQueue_{nullptr};
 
         SimTimer SimTime_;
@@ -69,14 +144,18 @@ class SimulationManager
         Timer SimulationTimer_;
         double QueueOutTime_{0.0};
         double SimulationTime_{0.0};
+        TickStats Stats_;
+        std::atomic<double> SimSeconds_{0.0};
 
         std::uint32_t SimStepSize_{10};
+        std::uint64_t Tick_{0};
+        std::uint32_t Seed_{std::mt19937::default_seed}; // Galaxy generation
 
-        b2World*    World_{nullptr};
         std::thread Thread_;
 
-        bool IsRunning_{false};
-        bool IsSimRunning_{false};
+        // Written by simulation and main thread, read by both
+        std::atomic<bool> IsRunning_{false};
+        std::atomic<bool> IsSimRunning_{false};
 };
 
 #endif // SIMULATION_MANAGER_HPP
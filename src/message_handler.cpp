@@ -0,0 +1,344 @@
+#include "message_handler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    constexpr std::size_t LOG_RING_SIZE = 4096;  // Events per thread, power of 2
+    constexpr std::size_t LOG_SOURCE_SIZE = 8;
+    constexpr std::size_t LOG_TEXT_SIZE = 232;   // Event size is 256 bytes
+    constexpr std::size_t LOG_MESSAGE_EVENTS_MAX = 64; // Longer messages are truncated
+
+    constexpr std::uint8_t LOG_FLAG_RAW = 1u << 0;
+    constexpr std::uint8_t LOG_FLAG_CONTINUED = 1u << 1; // Message continues in next event
+    constexpr std::uint8_t LOG_FLAG_TRUNCATED = 1u << 2;
+
+    static_assert((LOG_RING_SIZE & (LOG_RING_SIZE-1)) == 0, "Ring size must be a power of 2");
+    static_assert(LOG_TEXT_SIZE <= 255, "Text length must fit into event");
+
+    std::atomic<std::uint64_t> NextHandlerID{1};
+
+    // Ring buffer of the current thread and the handler it is registered at.
+    // The ring is shared with the handler, on thread exit it is marked as
+    // released, the handler frees it after writing remaining events.
+    struct ThreadRingHolder
+    {
+        ~ThreadRingHolder() {this->release();}
+
+        void release()
+        {
+            if (IsReleased != nullptr) IsReleased->store(true, std::memory_order_release);
+            IsReleased = nullptr;
+            Ring.reset();
+            Owner = 0;
+        }
+
+        std::uint64_t Owner{0};
+        std::shared_ptr<void> Ring;
+        std::atomic_bool* IsReleased{nullptr};
+    };
+    thread_local ThreadRingHolder ThreadRing;
+
+    const char* toLevelText(int _Level)
+    {
+        switch (_Level)
+        {
+            case MessageHandler::ERROR:    return "[ E  ]";
+            case MessageHandler::WARNING:  return "[ W  ]";
+            case MessageHandler::INFO:     return "[ I  ]";
+            case MessageHandler::DEBUG_L1: return "[ D1 ]";
+            case MessageHandler::DEBUG_L2: return "[ D2 ]";
+            case MessageHandler::DEBUG_L3: return "[ D3 ]";
+            default:                       return "[ ?  ]";
+        }
+    }
+}
+
+struct MessageHandler::Event
+{
+    std::int64_t Time;  // System clock, ns since epoch
+    std::uint8_t Level;
+    std::uint8_t Flags;
+    std::uint8_t Length;
+    char Source[LOG_SOURCE_SIZE];
+    char Text[LOG_TEXT_SIZE];
+};
+
+// Single producer (reporting thread), single consumer (writer thread)
+struct MessageHandler::Ring
+{
+    std::array<Event, LOG_RING_SIZE> Events;
+    alignas(64) std::atomic<std::size_t> Head{0};
+    alignas(64) std::atomic<std::size_t> Tail{0};
+    alignas(64) std::atomic<std::size_t> Dropped{0};
+    std::atomic_bool IsReleased{false};    // Thread exited, no more events
+};
+
+MessageHandler::MessageHandler() : ID_(NextHandlerID++)
+{
+    Writer_ = std::thread(&MessageHandler::run, this);
+}
+
+MessageHandler::~MessageHandler()
+{
+    {
+        std::lock_guard<std::mutex> Lock(WriterLock_);
+        IsRunning_ = false;
+    }
+    WriterCondition_.notify_one();
+    Writer_.join();
+}
+
+void MessageHandler::registerSource(const std::string& _Source, const std::string& _DisplayName)
+{
+    std::lock_guard<std::mutex> Lock(SourcesLock_);
+    SourceMap_.insert({_Source, _DisplayName});
+}
+
+void MessageHandler::report(const std::string& _Source, const std::string& _Message, const ReportLevelType _Level)
+{
+    if (!this->isActive(_Level)) return;
+    if (_Level == ERROR) ErrorFlag = true;
+
+    this->record(_Source.c_str(), _Message, _Level, false);
+}
+
+void MessageHandler::reportRaw(const std::string& _Message, const ReportLevelType _Level)
+{
+    if (!this->isActive(_Level)) return;
+
+    this->record("", _Message, _Level, true);
+}
+
+void MessageHandler::flush()
+{
+    std::lock_guard<std::mutex> Lock(WriterLock_);
+    this->write();
+}
+
+MessageHandler::Ring* MessageHandler::getRing()
+{
+    // A thread switching between handlers (only expected for tests and
+    // benchmarks) gets a new ring each time
+    if (ThreadRing.Owner != ID_)
+    {
+        ThreadRing.release();
+
+        auto r = std::make_shared<Ring>();
+        ThreadRing.Owner = ID_;
+        ThreadRing.Ring = r;
+        ThreadRing.IsReleased = &r->IsReleased;
+
+        std::lock_guard<std::mutex> Lock(RingsLock_);
+        Rings_.push_back(std::move(r));
+    }
+    return static_cast<Ring*>(ThreadRing.Ring.get());
+}
+
+void MessageHandler::record(const char* _Source, const std::string& _Message, ReportLevelType _Level, bool _IsRaw)
+{
+    auto* r = this->getRing();
+
+    const auto Time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::size_t NrOfEvents = std::max(std::size_t(1), (_Message.size() + LOG_TEXT_SIZE - 1) / LOG_TEXT_SIZE);
+    std::uint8_t Flags = _IsRaw ? LOG_FLAG_RAW : 0u;
+    if (NrOfEvents > LOG_MESSAGE_EVENTS_MAX)
+    {
+        NrOfEvents = LOG_MESSAGE_EVENTS_MAX;
+        Flags |= LOG_FLAG_TRUNCATED;
+    }
+
+    // All events of a message are published at once, so the writer never
+    // sees partial messages. Never block, drop if full.
+    const auto Head = r->Head.load(std::memory_order_relaxed);
+    if (LOG_RING_SIZE - (Head - r->Tail.load(std::memory_order_acquire)) < NrOfEvents)
+    {
+        r->Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::size_t Offset{0};
+    for (auto i=0u; i<NrOfEvents; ++i)
+    {
+        auto& e = r->Events[(Head+i) & (LOG_RING_SIZE-1)];
+        const auto Length = std::min(LOG_TEXT_SIZE, _Message.size() - Offset);
+
+        e.Time = Time;
+        e.Level = std::uint8_t(_Level);
+        e.Flags = Flags | (i+1 < NrOfEvents ? LOG_FLAG_CONTINUED : 0u);
+        e.Length = std::uint8_t(Length);
+        std::strncpy(e.Source, _Source, LOG_SOURCE_SIZE-1);
+        e.Source[LOG_SOURCE_SIZE-1] = '\0';
+        std::memcpy(e.Text, _Message.data() + Offset, Length);
+
+        Offset += Length;
+    }
+    r->Head.store(Head + NrOfEvents, std::memory_order_release);
+}
+
+void MessageHandler::run()
+{
+    std::unique_lock<std::mutex> Lock(WriterLock_);
+    while (IsRunning_)
+    {
+        this->write();
+        WriterCondition_.wait_for(Lock, std::chrono::milliseconds(5), [this]{return !IsRunning_;});
+    }
+    this->write();
+}
+
+std::size_t MessageHandler::write()
+{
+    struct Record
+    {
+        std::int64_t Time;
+        int Level;
+        std::uint8_t Flags;
+        std::string Source;
+        std::string Text;
+    };
+    std::vector<Record> Records;
+    std::size_t NrOfDropped{0};
+
+    //--- Collect ---//
+    {
+        std::lock_guard<std::mutex> Lock(RingsLock_);
+        bool IsAnyReleased{false};
+        for (auto& r : Rings_)
+        {
+            // Released before reading the head, hence, no events follow
+            const bool IsReleased = r->IsReleased.load(std::memory_order_acquire);
+            IsAnyReleased |= IsReleased;
+
+            auto Tail = r->Tail.load(std::memory_order_relaxed);
+            const auto Head = r->Head.load(std::memory_order_acquire);
+            bool IsContinued{false};
+            while (Tail != Head)
+            {
+                const auto& e = r->Events[Tail & (LOG_RING_SIZE-1)];
+                if (IsContinued)
+                    Records.back().Text.append(e.Text, e.Length);
+                else
+                    Records.push_back({e.Time, e.Level, e.Flags, e.Source, std::string(e.Text, e.Length)});
+                IsContinued = e.Flags & LOG_FLAG_CONTINUED;
+                ++Tail;
+            }
+            r->Tail.store(Tail, std::memory_order_release);
+            NrOfDropped += r->Dropped.exchange(0, std::memory_order_relaxed);
+        }
+        if (IsAnyReleased)
+        {
+            // Only released rings are checked, their events are all written
+            Rings_.erase(std::remove_if(Rings_.begin(), Rings_.end(),
+                                        [](const auto& _r)
+                                        {
+                                            return _r->IsReleased.load(std::memory_order_acquire) &&
+                                                   _r->Tail.load(std::memory_order_relaxed) ==
+                                                   _r->Head.load(std::memory_order_acquire);
+                                        }),
+                         Rings_.end());
+        }
+    }
+    if (Records.empty() && NrOfDropped == 0) return 0;
+
+    // Merge threads, order within a thread is kept
+    std::stable_sort(Records.begin(), Records.end(),
+                     [](const Record& _a, const Record& _b){return _a.Time < _b.Time;});
+
+    //--- Format ---//
+    std::string Out;
+    std::string Err;
+    const bool IsColored = IsColored_;
+    {
+        std::lock_guard<std::mutex> Lock(SourcesLock_);
+        for (const auto& Rec : Records)
+        {
+            if (Rec.Flags & LOG_FLAG_RAW)
+            {
+                Out += Rec.Text;
+                continue;
+            }
+
+            auto& s = (Rec.Level == ERROR) ? Err : Out;
+
+            std::time_t t = Rec.Time / 1000000000;
+            std::tm Local;
+            localtime_r(&t, &Local);
+            char TimeText[32];
+            std::strftime(TimeText, sizeof(TimeText), "%Y-%m-%d %X", &Local);
+
+            if (IsColored && Rec.Level == ERROR) s += "\033[31m";
+            else if (IsColored && Rec.Level == WARNING) s += "\033[33m";
+            s += TimeText;
+            s += "   ";
+            s += toLevelText(Rec.Level);
+
+            const auto it = SourceMap_.find(Rec.Source);
+            if (it != SourceMap_.end())
+            {
+                s += "[ " + it->second + " ] ";
+            }
+            else
+            {
+                s += "[ " + Rec.Source + ": source not found ] ";
+            }
+            s += Rec.Text;
+            if (Rec.Flags & LOG_FLAG_TRUNCATED) s += " [truncated]";
+            if (IsColored && (Rec.Level == ERROR || Rec.Level == WARNING)) s += "\033[0m";
+            s += '\n';
+        }
+    }
+    if (NrOfDropped > 0)
+    {
+        Err += "Message handler: " + std::to_string(NrOfDropped) + " message(s) dropped, buffer full\n";
+    }
+
+    //--- Write ---//
+    // Flushed once per batch instead of each line
+    if (!Out.empty())
+    {
+        std::fwrite(Out.data(), 1, Out.size(), stdout);
+        std::fflush(stdout);
+    }
+    if (!Err.empty())
+    {
+        std::fwrite(Err.data(), 1, Err.size(), stderr);
+        std::fflush(stderr);
+    }
+    return Records.size();
+}
+
+MessageStreamBuffer::int_type MessageStreamBuffer::overflow(int_type _c)
+{
+    if (traits_type::eq_int_type(_c, traits_type::eof())) return traits_type::not_eof(_c);
+
+    const char c = traits_type::to_char_type(_c);
+    if (c == '\n')
+    {
+        Messages_.report(Source_, Prefix_+Line_, Level_);
+        Line_.clear();
+    }
+    else
+    {
+        Line_ += c;
+    }
+    return _c;
+}
+
+std::streamsize MessageStreamBuffer::xsputn(const char* _s, std::streamsize _n)
+{
+    // Filter before buffering anything
+    if (!Messages_.isActive(Level_)) return _n;
+
+    for (std::streamsize i=0; i<_n; ++i)
+    {
+        this->overflow(traits_type::to_int_type(_s[i]));
+    }
+    return _n;
+}
@@ -2,13 +2,16 @@
 #define MESSAGE_HANDLER_H
 
 #include <atomic>
-#include <cassert>
 #include <chrono>
-#include <iomanip>
-#include <iostream>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
-#include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 // Only compile debug blocks in debug mode
 #ifdef NDEBUG
@@ -17,11 +20,31 @@
     #define DBLK(x) x
 #endif
 
+// Checks the level before the message is evaluated, hence, messages built
+// from strings and numbers are only formatted if they are reported. Use it
+// for messages on hot paths, e.g. per tick or per request.
+#define MSG_REPORT(Messages, Source, Message, Level)                      \
+    do                                                                    \
+    {                                                                     \
+        auto& MsgReportHandler_ = (Messages);                             \
+        if (MsgReportHandler_.isActive(Level))                            \
+            MsgReportHandler_.report(Source, Message, Level);             \
+    } while (false)
+
+// Messages are reported asynchronously. Each reporting thread records
+// fixed-size binary events into its own lock-free ring buffer, severity is
+// filtered before anything is recorded. A background thread collects the
+// events, formats and writes them. Hence, reporting threads never block on
+// I/O. If a ring buffer is full, messages are dropped and the number of
+// dropped messages is reported. Rings of exited threads are released once
+// they are drained.
+// report() filters after its arguments were built, use MSG_REPORT to avoid
+// formatting messages that aren't reported.
 class MessageHandler
 {
-    
+
     public:
-        
+
         typedef enum
         {
             ERROR = 0,
@@ -32,100 +55,83 @@ class MessageHandler
             DEBUG_L3 = 5
         } ReportLevelType;
 
+        MessageHandler();
+        ~MessageHandler();
+        MessageHandler(const MessageHandler&) = delete;
+        MessageHandler& operator=(const MessageHandler&) = delete;
+
         bool checkError()
         {
             return ErrorFlag.exchange(false);
         }
 
-        void registerSource(const std::string& _Source, const std::string& _DisplayName)
-        {
-            SourceMap_.insert({_Source, _DisplayName});
-        }
-        
-        void report(const std::string& _Source, const std::string& _Message, const ReportLevelType _Level = ERROR)
-        {
-            auto t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-
-            std::stringstream Message;
-            std::string L;
-
-            switch (_Level)
-            {
-                case ERROR:
-                    L = "[ E  ]";
-                    break;
-                case WARNING:
-                    L = "[ W  ]";
-                    break;
-                case INFO:
-                    L = "[ I  ]";
-                    break;
-                case DEBUG_L1:
-                case DEBUG_L2:
-                case DEBUG_L3:
-                    L = "[ D" + std::to_string(_Level-2) + " ]";
-                    break;
-                default:
-                    L = "[ ?  ]";
-
-            }
-            if (_Level <= Level_)
-            {
-                if (IsColored_)
-                {
-                    if (_Level == 0)
-                    {
-                        Message << "\033[31m";
-                    }
-                    else if (_Level == 1)
-                    {
-                        Message << "\033[33m";
-                    }
-                }
-                Message << std::put_time(std::localtime(&t), "%Y-%m-%d %X") << "   ";
-
-                if (SourceMap_.count(_Source) == 1)
-                {
-                    Message << L << "[ " << SourceMap_[_Source] << " ] " <<  _Message;
-                }
-                else
-                {
-                    Message << L << "[ " << _Source << ": source not found ] " <<  _Message;
-                }
-                if (IsColored_ && (_Level == 0 || _Level == 1))
-                {
-                    Message << "\033[0m";
-                }
-                if (_Level == 0)
-                {
-                    std::cerr << Message.str() << std::endl;
-                    ErrorFlag = true;
-                }
-                else
-                    std::cout << Message.str() << std::endl;
-            }
-        }
+        bool isActive(const ReportLevelType _Level) const {return _Level <= Level_.load(std::memory_order_relaxed);}
 
-        void reportRaw(const std::string& _Message, const ReportLevelType _Level = INFO)
-        {
-            if (_Level <= Level_)
-            {
-                std::cout << _Message;
-            }
-        }
+        void registerSource(const std::string& _Source, const std::string& _DisplayName);
+        void report(const std::string& _Source, const std::string& _Message, const ReportLevelType _Level = ERROR);
+        void reportRaw(const std::string& _Message, const ReportLevelType _Level = INFO);
 
         void setColored(bool _IsColored) {IsColored_ = _IsColored;}
         void setLevel(ReportLevelType _Level) {Level_ = _Level;}
 
+        // Write all pending messages, blocks the calling thread
+        void flush();
+
     private:
 
+        struct Event;
+        struct Ring;
+
+        Ring* getRing();
+        void record(const char* _Source, const std::string& _Message, ReportLevelType _Level, bool _IsRaw);
+        void run();
+        std::size_t write();
+
         std::atomic_bool ErrorFlag{false};
         std::atomic<ReportLevelType> Level_{DEBUG_L3};
+        std::atomic_bool IsColored_{true};
+
+        // Rings are registered once per thread
+        std::uint64_t ID_{0};
+        std::mutex RingsLock_;
+        std::vector<std::shared_ptr<Ring>> Rings_;  // Shared with their threads
 
-        bool IsColored_{true};
-        // Map source identifiers to display names
+        // Map source identifiers to display names, used by writer thread
+        std::mutex SourcesLock_;
         std::unordered_map<std::string, std::string> SourceMap_;
 
+        std::mutex WriterLock_;
+        std::condition_variable WriterCondition_;
+        bool IsRunning_{true};
+        std::thread Writer_;
+
+};
+
+// Stream buffer reporting each line written to it, e.g. to redirect logs of
+// 3rd party libraries
+class MessageStreamBuffer : public std::streambuf
+{
+
+    public:
+
+        MessageStreamBuffer(MessageHandler& _Messages, const std::string& _Source,
+                            const std::string& _Prefix, MessageHandler::ReportLevelType _Level) :
+                            Messages_(_Messages), Source_(_Source), Prefix_(_Prefix), Level_(_Level) {}
+
+    protected:
+
+        int_type overflow(int_type _c) override;
+        std::streamsize xsputn(const char* _s, std::streamsize _n) override;
+
+    private:
+
+        MessageHandler& Messages_;
+        std::string Source_;
+        std::string Prefix_;
+        MessageHandler::ReportLevelType Level_;
+
+        std::string Line_;
+
 };
 
 #endif // MESSAGE_HANDLER_H
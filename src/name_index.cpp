@@ -0,0 +1,365 @@
+#include "name_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+    char fold(char _c)
+    {
+        return (_c >= 'A' && _c <= 'Z') ? char(_c - 'A' + 'a') : _c;
+    }
+
+    // Folded, truncated like names in NameComponent
+    std::string_view foldKey(std::string_view _s, std::array<char, NAME_SIZE_MAX>& _Buffer)
+    {
+        const auto n = std::min(_s.size(), NAME_SIZE_MAX-1);
+        for (auto i=0u; i<n; ++i) _Buffer[i] = fold(_s[i]);
+        _Buffer[n] = '\0';
+        return {_Buffer.data(), n};
+    }
+
+    // Same order as keys of the sorted index
+    bool isLess(const char* _a, const char* _b)
+    {
+        while (*_a != '\0' && fold(*_a) == fold(*_b)) {++_a; ++_b;}
+        return std::uint8_t(fold(*_a)) < std::uint8_t(fold(*_b));
+    }
+}
+
+void NameIndex::add(entt::entity _e, std::string_view _Name, bool _IsStarSystem)
+{
+    const auto n = std::min(_Name.size(), NAME_SIZE_MAX-1);
+
+    Entries_.push_back({std::uint32_t(Names_.size()), std::uint32_t(n), _e, _IsStarSystem});
+    for (auto i=0u; i<n; ++i)
+    {
+        Names_.push_back(_Name[i]);
+        Keys_.push_back(fold(_Name[i]));
+    }
+    Names_.push_back('\0');
+    Keys_.push_back('\0');
+}
+
+void NameIndex::addProcedural(entt::entity _e, const ProceduralNameComponent& _Name)
+{
+    auto& Entities = Procedural_[std::size_t(_Name.Type)];
+    if (_Name.Index >= Entities.size()) Entities.resize(std::size_t(_Name.Index)+1, entt::null);
+    if (Entities[_Name.Index] == entt::null) ++NumberOfProcedural_;
+    Entities[_Name.Index] = _e;
+}
+
+void NameIndex::build()
+{
+    const auto n = std::uint32_t(Entries_.size());
+
+    Sorted_.resize(n);
+    for (auto i=0u; i<n; ++i) Sorted_[i] = i;
+    std::sort(Sorted_.begin(), Sorted_.end(),
+              [this](auto _a, auto _b){return std::strcmp(this->getKey(_a), this->getKey(_b)) < 0;});
+
+    // Load factor below 0.5 keeps probe sequences short
+    std::size_t Size{16};
+    while (Size < 2*std::size_t(n)) Size *= 2;
+    Table_.assign(Size, 0);
+    for (auto i=0u; i<n; ++i)
+    {
+        auto Slot = hash({this->getKey(i), Entries_[i].Length}) & (Size-1);
+        while (Table_[Slot] != 0) Slot = (Slot+1) & (Size-1);
+        Table_[Slot] = i+1;
+    }
+}
+
+void NameIndex::find(std::string_view _Name, std::size_t _Max, std::vector<Match>& _Matches) const
+{
+    std::array<char, NAME_SIZE_MAX> Buffer;
+    const auto Key = foldKey(_Name, Buffer);
+
+    // Equal names end up in the same probe sequence
+    std::size_t n{0};
+    if (!Table_.empty())
+    {
+        const auto Size = Table_.size();
+        auto Slot = hash(Key) & (Size-1);
+        while (Table_[Slot] != 0 && n < _Max)
+        {
+            const auto i = Table_[Slot]-1;
+            if (Entries_[i].Length == Key.size() && std::memcmp(this->getKey(i), Key.data(), Key.size()) == 0)
+            {
+                _Matches.push_back(this->toMatch(i));
+                ++n;
+            }
+            Slot = (Slot+1) & (Size-1);
+        }
+    }
+
+    // Procedural names are parsed, prefix followed by the index without
+    // leading zeros
+    for (auto t=0u; t<Procedural_.size() && n < _Max; ++t)
+    {
+        std::array<char, NAME_SIZE_MAX> BufferPrefix;
+        const auto Prefix = foldKey(PROCEDURAL_NAME_PREFIXES[t], BufferPrefix);
+        if (Key.substr(0, Prefix.size()) != Prefix) continue;
+
+        const auto Digits = Key.substr(Prefix.size());
+        if (Digits.empty() || (Digits[0] == '0' && Digits.size() > 1)) continue;
+
+        std::uint32_t i{0};
+        const auto Result = std::from_chars(Digits.data(), Digits.data()+Digits.size(), i);
+        if (Result.ec != std::errc() || Result.ptr != Digits.data()+Digits.size()) continue;
+
+        if (i < Procedural_[t].size() && Procedural_[t][i] != entt::null)
+        {
+            _Matches.push_back(this->toProceduralMatch(t, i));
+            ++n;
+        }
+    }
+}
+
+void NameIndex::findPrefix(std::string_view _Prefix, std::size_t _Max, std::vector<Match>& _Matches) const
+{
+    std::array<char, NAME_SIZE_MAX> Buffer;
+    const auto Prefix = foldKey(_Prefix, Buffer);
+
+    std::vector<Match> Candidates;
+    auto it = std::lower_bound(Sorted_.begin(), Sorted_.end(), Prefix,
+                               [this](auto _i, std::string_view _p){return std::string_view(this->getKey(_i)) < _p;});
+    for (std::size_t n=0; it != Sorted_.end() && n < _Max; ++it, ++n)
+    {
+        if (std::strncmp(this->getKey(*it), Prefix.data(), Prefix.size()) != 0) break;
+        Candidates.push_back(this->toMatch(*it));
+    }
+    for (auto t=0u; t<Procedural_.size(); ++t) this->findPrefixProcedural(t, Prefix, _Max, Candidates);
+
+    // Each source is ordered, the first _Max of all of them are returned
+    std::stable_sort(Candidates.begin(), Candidates.end(),
+                     [](const Match& _a, const Match& _b){return isLess(_a.Name, _b.Name);});
+    if (Candidates.size() > _Max) Candidates.resize(_Max);
+    _Matches.insert(_Matches.end(), Candidates.begin(), Candidates.end());
+}
+
+void NameIndex::findPrefixProcedural(std::size_t _Type, std::string_view _Prefix, std::size_t _Max,
+                                     std::vector<Match>& _Matches) const
+{
+    std::array<char, NAME_SIZE_MAX> Buffer;
+    const auto Name = foldKey(PROCEDURAL_NAME_PREFIXES[_Type], Buffer);
+
+    // Either the query is a prefix of the name's prefix, or it continues
+    // with the first digits of the index
+    std::string_view Digits;
+    if (_Prefix.size() <= Name.size())
+    {
+        if (Name.substr(0, _Prefix.size()) != _Prefix) return;
+    }
+    else
+    {
+        if (_Prefix.substr(0, Name.size()) != Name) return;
+        Digits = _Prefix.substr(Name.size());
+    }
+
+    const auto& Entities = Procedural_[_Type];
+    const std::uint64_t Size = Entities.size();
+    std::size_t n{0};
+
+    // Depth first through the digits, which is the order of names
+    auto Visit = [&](auto& _Self, std::uint64_t _i) -> void
+    {
+        if (Entities[_i] != entt::null)
+        {
+            _Matches.push_back(this->toProceduralMatch(_Type, std::uint32_t(_i)));
+            ++n;
+        }
+        if (_i == 0) return; // No leading zeros
+        for (auto d=0u; d<10 && n<_Max; ++d)
+        {
+            const auto c = _i*10+d;
+            if (c >= Size) break;
+            _Self(_Self, c);
+        }
+    };
+
+    if (Digits.empty())
+    {
+        for (auto d=0u; d<10 && d<Size && n<_Max; ++d) Visit(Visit, d);
+        return;
+    }
+    if (Digits[0] == '0' && Digits.size() > 1) return;
+    std::uint64_t i{0};
+    for (auto c : Digits)
+    {
+        if (c < '0' || c > '9') return;
+        i = i*10 + std::uint64_t(c-'0');
+        if (i >= Size) return;
+    }
+    Visit(Visit, i);
+}
+
+void NameIndex::findFuzzy(std::string_view _Name, std::uint32_t _MaxDistance, std::size_t _Max,
+                          std::vector<Match>& _Matches) const
+{
+    std::array<char, NAME_SIZE_MAX> Buffer;
+    const auto Query = foldKey(_Name, Buffer);
+    const auto m = Query.size();
+
+    // Row d holds distances between the first d characters of the current
+    // name and all prefixes of the query
+    RowsType Rows;
+    for (auto j=0u; j<=m; ++j) Rows[0][j] = std::uint8_t(j);
+
+    // Best matches first, one bucket per distance
+    BucketsType Buckets(_MaxDistance+1);
+
+    const char* Previous{""};
+    std::size_t Valid{0};   // Rows valid for Previous up to this depth
+
+    auto it = Sorted_.begin();
+    while (it != Sorted_.end())
+    {
+        const auto* Key = this->getKey(*it);
+        const std::size_t Length = Entries_[*it].Length;
+
+        // Rows of the common prefix with the previous name are reused
+        std::size_t d{0};
+        while (d < Valid && d < Length && Key[d] == Previous[d]) ++d;
+
+        bool IsPruned{false};
+        for (; d < Length; ++d)
+        {
+            if (extendRow(Rows, d, Key[d], Query) > _MaxDistance)
+            {
+                IsPruned = true;
+                break;
+            }
+        }
+
+        Previous = Key;
+        if (IsPruned)
+        {
+            // Skip all names sharing the prefix exceeding the distance
+            const auto n = d+1;
+            Valid = d;
+            // Skipped ranges are mostly short, hence, galloping search
+            auto HasPrefix = [this, Key, n](auto _i){return std::strncmp(this->getKey(_i), Key, n) == 0;};
+            auto First = it+1;
+            std::ptrdiff_t Step{1};
+            while (Sorted_.end() - First > Step && HasPrefix(First[Step])) {First += Step; Step *= 2;}
+            const auto Last = (Sorted_.end() - First > Step) ? First+Step : Sorted_.end();
+            it = std::partition_point(First, Last, HasPrefix);
+            continue;
+        }
+        Valid = Length;
+
+        const auto Distance = Rows[Length][m];
+        if (Distance <= _MaxDistance && Buckets[Distance].size() < _Max)
+        {
+            Buckets[Distance].push_back(this->toMatch(*it, Distance));
+            if (Distance == 0 && Buckets[0].size() == _Max) break;
+        }
+        ++it;
+    }
+    for (auto t=0u; t<Procedural_.size(); ++t)
+    {
+        this->findFuzzyProcedural(t, Query, _MaxDistance, _Max, Rows, Buckets);
+    }
+
+    std::size_t n{0};
+    for (auto& Bucket : Buckets)
+    {
+        std::stable_sort(Bucket.begin(), Bucket.end(),
+                         [](const Match& _a, const Match& _b){return isLess(_a.Name, _b.Name);});
+        for (const auto& Match : Bucket)
+        {
+            if (n++ == _Max) return;
+            _Matches.push_back(Match);
+        }
+    }
+}
+
+void NameIndex::findFuzzyProcedural(std::size_t _Type, std::string_view _Query, std::uint32_t _MaxDistance,
+                                    std::size_t _Max, RowsType& _Rows, BucketsType& _Buckets) const
+{
+    const auto& Entities = Procedural_[_Type];
+    if (Entities.empty()) return;
+
+    std::array<char, NAME_SIZE_MAX> Buffer;
+    const auto Prefix = foldKey(PROCEDURAL_NAME_PREFIXES[_Type], Buffer);
+    for (auto d=0u; d<Prefix.size(); ++d)
+    {
+        if (extendRow(_Rows, d, Prefix[d], _Query) > _MaxDistance) return;
+    }
+
+    const std::uint64_t Size = Entities.size();
+    const auto m = _Query.size();
+
+    // Digits of indices as a trie, subtrees exceeding the distance are
+    // skipped
+    auto Visit = [&](auto& _Self, std::uint64_t _i, std::size_t _Depth) -> void
+    {
+        const auto Distance = _Rows[_Depth][m];
+        if (Entities[_i] != entt::null && Distance <= _MaxDistance && _Buckets[Distance].size() < _Max)
+            _Buckets[Distance].push_back(this->toProceduralMatch(_Type, std::uint32_t(_i), Distance));
+
+        if (_i == 0 || _Depth+1 >= NAME_SIZE_MAX) return; // No leading zeros
+        for (auto d=0u; d<10; ++d)
+        {
+            const auto c = _i*10+d;
+            if (c >= Size) break;
+            if (extendRow(_Rows, _Depth, char('0'+d), _Query) > _MaxDistance) continue;
+            _Self(_Self, c, _Depth+1);
+        }
+    };
+    for (auto d=0u; d<10 && d<Size; ++d)
+    {
+        if (extendRow(_Rows, Prefix.size(), char('0'+d), _Query) > _MaxDistance) continue;
+        Visit(Visit, d, Prefix.size()+1);
+    }
+}
+
+std::uint8_t NameIndex::extendRow(RowsType& _Rows, std::size_t _d, char _c, std::string_view _Query)
+{
+    const auto& r = _Rows[_d];
+    auto& s = _Rows[_d+1];
+    s[0] = std::uint8_t(_d+1);
+    auto Min = s[0];
+    for (auto j=1u; j<=_Query.size(); ++j)
+    {
+        s[j] = std::min({std::uint8_t(r[j]+1), std::uint8_t(s[j-1]+1),
+                         std::uint8_t(r[j-1] + (_c != _Query[j-1]))});
+        Min = std::min(Min, s[j]);
+    }
+    return Min;
+}
+
+NameIndex::Match NameIndex::toMatch(std::uint32_t _i, std::uint32_t _Distance) const
+{
+    Match m;
+    m.ID = Entries_[_i].ID;
+    std::memcpy(m.Name, this->getName(_i), Entries_[_i].Length+1);
+    m.Distance = _Distance;
+    m.IsStarSystem = Entries_[_i].IsStarSystem;
+    return m;
+}
+
+NameIndex::Match NameIndex::toProceduralMatch(std::size_t _Type, std::uint32_t _i, std::uint32_t _Distance) const
+{
+    Match m;
+    m.ID = Procedural_[_Type][_i];
+    toProceduralName({ProceduralNameType(_Type), _i}, m.Name);
+    m.Distance = _Distance;
+    m.IsStarSystem = ProceduralNameType(_Type) == ProceduralNameType::SYSTEM;
+    return m;
+}
+
+std::uint64_t NameIndex::hash(std::string_view _Key)
+{
+    // FNV-1a
+    std::uint64_t h = 14695981039346656037ull;
+    for (auto c : _Key)
+    {
+        h ^= std::uint8_t(c);
+        h *= 1099511628211ull;
+    }
+    return h ^ (h >> 32);
+}
@@ -0,0 +1,97 @@
+#ifndef NAME_INDEX_HPP
+#define NAME_INDEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <entt/entity/entity.hpp>
+
+#include "name_component.hpp"
+
+// Maximum number of results of a name query
+constexpr std::size_t NAME_SEARCH_RESULTS_MAX = 32;
+
+// Immutable index of entity names for exact, prefix and fuzzy lookup. It
+// is built once by the simulation thread (see NameSystem) and then shared
+// read-only, hence, it can be queried from any thread without locking.
+// Lookups are case insensitive (ASCII).
+// Names are interned in one buffer, exact lookup uses an open addressing
+// hash table, prefix and fuzzy search use an index sorted by name. Fuzzy
+// search walks the sorted index like a trie, hence, Levenshtein rows of
+// common prefixes are reused and whole subtrees of names are skipped as
+// soon as they exceed the maximum distance.
+// Names of generated objects (e.g. "Star_123", see ProceduralNameComponent)
+// aren't stored, only their entities by type and index. Queries are parsed
+// into indices, candidates are enumerated in the order of their names by
+// walking the digits of indices like a trie.
+class NameIndex
+{
+
+    public:
+
+        struct Match
+        {
+            entt::entity  ID{entt::null};
+            char          Name[NAME_SIZE_MAX]{};
+            std::uint32_t Distance{0};     // Fuzzy search only
+            bool          IsStarSystem{false};
+        };
+
+        // Building, procedural names of type SYSTEM are star systems
+        void add(entt::entity _e, std::string_view _Name, bool _IsStarSystem);
+        void addProcedural(entt::entity _e, const ProceduralNameComponent& _Name);
+        void build();
+
+        std::size_t size() const {return Entries_.size() + NumberOfProcedural_;}
+
+        // Results are appended to _Matches, at most _Max of them
+        void find(std::string_view _Name, std::size_t _Max, std::vector<Match>& _Matches) const;
+        void findPrefix(std::string_view _Prefix, std::size_t _Max, std::vector<Match>& _Matches) const;
+        void findFuzzy(std::string_view _Name, std::uint32_t _MaxDistance, std::size_t _Max,
+                       std::vector<Match>& _Matches) const;
+
+    private:
+
+        struct Entry
+        {
+            std::uint32_t Offset{0};
+            std::uint32_t Length{0};
+            entt::entity  ID{entt::null};
+            bool          IsStarSystem{false};
+        };
+
+        // Levenshtein distances, row d for the first d characters of a name
+        using RowsType = std::array<std::array<std::uint8_t, NAME_SIZE_MAX>, NAME_SIZE_MAX>;
+        // Matches by distance
+        using BucketsType = std::vector<std::vector<Match>>;
+
+        static std::uint64_t hash(std::string_view _Key);
+        // Computes row _d+1 for character _c, returns its minimum
+        static std::uint8_t extendRow(RowsType& _Rows, std::size_t _d, char _c, std::string_view _Query);
+
+        const char* getKey(std::uint32_t _i) const {return Keys_.data() + Entries_[_i].Offset;}
+        const char* getName(std::uint32_t _i) const {return Names_.data() + Entries_[_i].Offset;}
+        Match toMatch(std::uint32_t _i, std::uint32_t _Distance = 0) const;
+        Match toProceduralMatch(std::size_t _Type, std::uint32_t _i, std::uint32_t _Distance = 0) const;
+
+        void findPrefixProcedural(std::size_t _Type, std::string_view _Prefix, std::size_t _Max,
+                                  std::vector<Match>& _Matches) const;
+        void findFuzzyProcedural(std::size_t _Type, std::string_view _Query, std::uint32_t _MaxDistance,
+                                 std::size_t _Max, RowsType& _Rows, BucketsType& _Buckets) const;
+
+        // Original and case folded names, same offsets, null-terminated
+        std::vector<char>  Names_;
+        std::vector<char>  Keys_;
+        std::vector<Entry> Entries_;
+
+        std::vector<std::uint32_t> Sorted_;     // Entries by key
+        std::vector<std::uint32_t> Table_;      // Entry + 1, 0 if empty
+
+        // Entities of procedural names by type and index, null if unused
+        std::array<std::vector<entt::entity>, PROCEDURAL_NAME_TYPES> Procedural_;
+        std::size_t NumberOfProcedural_{0};
+};
+
+#endif // NAME_INDEX_HPP
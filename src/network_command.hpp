@@ -0,0 +1,243 @@
+#ifndef NETWORK_COMMAND_HPP
+#define NETWORK_COMMAND_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include <entt/entity/entity.hpp>
+
+#include "network_message.hpp"
+
+enum class NetworkMethodType : std::uint8_t
+{
+    INVALID,
+    CMD_ACCELERATE_SIMULATION,
+    CMD_DUMP_TRACE,
+    CMD_FIND_NAME,
+    CMD_GALAXY_CHUNK,
+    CMD_GALAXY_DENSITY,
+    CMD_PARTICLE_POPULATION,
+    CMD_RESET_PERF_STATS,
+    CMD_SAVE_CHECKPOINT,
+    CMD_SEARCH_NAME,
+    CMD_SEARCH_NAME_FUZZY,
+    CMD_SHUTDOWN,
+    CMD_START_SIMULATION,
+    CMD_STOP_SIMULATION,
+    SUB_DYNAMIC_DATA,
+    SUB_GALAXY_DATA,
+    SUB_PERF_STATS,
+    SUB_SIM_STATS,
+    SUB_SYSTEM,
+    UNS_DYNAMIC_DATA,
+    UNS_GALAXY_DATA,
+    UNS_PERF_STATS,
+    UNS_SIM_STATS,
+    UNS_SYSTEM
+};
+
+// Thread a command is executed by
+enum class NetworkRouteType : std::uint8_t
+{
+    MAIN,
+    NET,
+    SIM
+};
+
+// Expected JSON-RPC parameters, validated before routing
+enum class NetworkParamsType : std::uint8_t
+{
+    NONE,
+    NUMBER,
+    NUMBER_PAIR,
+    STRING
+};
+
+// Bitmask of allowed classifications (subscription frequencies)
+namespace NetworkClass
+{
+    constexpr std::uint8_t CMD = 1u << 0;
+    constexpr std::uint8_t EVT = 1u << 1;
+    constexpr std::uint8_t S01 = 1u << 2;
+    constexpr std::uint8_t S05 = 1u << 3;
+    constexpr std::uint8_t S1  = 1u << 4;
+    constexpr std::uint8_t S5  = 1u << 5;
+    constexpr std::uint8_t S10 = 1u << 6;
+    constexpr std::uint8_t SUB_ANY = EVT | S01 | S05 | S1 | S5 | S10;
+    constexpr std::uint8_t SUB_FREQ = S01 | S05 | S1 | S5 | S10;
+}
+
+// Decoded and validated request. This is what crosses the queues to the
+// simulation and network threads, hence, no JSON or string handling is
+// needed there. String parameters are resolved by the broker, e.g. names
+// to entity IDs.
+struct NetworkCommand
+{
+    entt::entity ClientID{entt::null};
+    std::uint32_t RequestID{0};
+    NetworkMethodType Method{NetworkMethodType::INVALID};
+    NetworkMessageClassificationType Class{NetworkMessageClassificationType::INVALID};
+    double Number{0.0};
+    double Number2{0.0};    // Second of a pair, e.g. coordinates
+};
+
+struct NetworkMethodEntry
+{
+    std::string_view Name;           // Method without frequency suffix
+    std::string_view Description;    // Used for logging
+    std::string_view AllowedText;    // Error data if classification not allowed
+    NetworkMethodType Method;
+    NetworkRouteType Route;
+    NetworkParamsType Params;
+    std::uint8_t Classes;
+};
+
+constexpr std::array<NetworkMethodEntry, 23> NETWORK_METHODS
+{{
+    {"cmd_accelerate_simulation", "Simulation acceleration", "",
+     NetworkMethodType::CMD_ACCELERATE_SIMULATION, NetworkRouteType::SIM, NetworkParamsType::NUMBER, NetworkClass::CMD},
+    {"cmd_dump_trace", "Trace dump", "",
+     NetworkMethodType::CMD_DUMP_TRACE, NetworkRouteType::MAIN, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"cmd_find_name", "Name lookup", "",
+     NetworkMethodType::CMD_FIND_NAME, NetworkRouteType::MAIN, NetworkParamsType::STRING, NetworkClass::CMD},
+    {"cmd_galaxy_chunk", "Galaxy chunk", "",
+     NetworkMethodType::CMD_GALAXY_CHUNK, NetworkRouteType::MAIN, NetworkParamsType::NUMBER_PAIR, NetworkClass::CMD},
+    {"cmd_galaxy_density", "Galaxy density", "",
+     NetworkMethodType::CMD_GALAXY_DENSITY, NetworkRouteType::MAIN, NetworkParamsType::NUMBER, NetworkClass::CMD},
+    {"cmd_particle_population", "Particle population", "",
+     NetworkMethodType::CMD_PARTICLE_POPULATION, NetworkRouteType::SIM, NetworkParamsType::NUMBER_PAIR, NetworkClass::CMD},
+    {"cmd_reset_perf_stats", "Performance stats reset", "",
+     NetworkMethodType::CMD_RESET_PERF_STATS, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"cmd_save_checkpoint", "Checkpoint", "",
+     NetworkMethodType::CMD_SAVE_CHECKPOINT, NetworkRouteType::MAIN, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"cmd_search_name", "Name prefix search", "",
+     NetworkMethodType::CMD_SEARCH_NAME, NetworkRouteType::MAIN, NetworkParamsType::STRING, NetworkClass::CMD},
+    {"cmd_search_name_fuzzy", "Fuzzy name search", "",
+     NetworkMethodType::CMD_SEARCH_NAME_FUZZY, NetworkRouteType::MAIN, NetworkParamsType::STRING, NetworkClass::CMD},
+    {"cmd_shutdown", "Server shutdown", "",
+     NetworkMethodType::CMD_SHUTDOWN, NetworkRouteType::MAIN, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"cmd_start_simulation", "Simulation start", "",
+     NetworkMethodType::CMD_START_SIMULATION, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"cmd_stop_simulation", "Simulation stop", "",
+     NetworkMethodType::CMD_STOP_SIMULATION, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::CMD},
+    {"sub_dynamic_data", "dynamic data", "",
+     NetworkMethodType::SUB_DYNAMIC_DATA, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_ANY},
+    {"sub_galaxy_data", "galaxy data", "Allowed subscription types: [evt]",
+     NetworkMethodType::SUB_GALAXY_DATA, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::EVT},
+    {"sub_perf_stats", "performance stats", "Allowed subscription types: [s01, s05, s1, s5, s10]",
+     NetworkMethodType::SUB_PERF_STATS, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_FREQ},
+    {"sub_sim_stats", "sim stats", "Allowed subscription types: [s01, s05, s1, s5, s10]",
+     NetworkMethodType::SUB_SIM_STATS, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_FREQ},
+    {"sub_system", "star system", "Allowed subscription types: [evt]",
+     NetworkMethodType::SUB_SYSTEM, NetworkRouteType::SIM, NetworkParamsType::STRING, NetworkClass::EVT},
+    {"uns_dynamic_data", "dynamic data", "",
+     NetworkMethodType::UNS_DYNAMIC_DATA, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_ANY},
+    {"uns_galaxy_data", "galaxy data", "Allowed subscription types: [evt]",
+     NetworkMethodType::UNS_GALAXY_DATA, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::EVT},
+    {"uns_perf_stats", "performance stats", "Allowed subscription types: [s01, s05, s1, s5, s10]",
+     NetworkMethodType::UNS_PERF_STATS, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_FREQ},
+    {"uns_sim_stats", "sim stats", "Allowed subscription types: [s01, s05, s1, s5, s10]",
+     NetworkMethodType::UNS_SIM_STATS, NetworkRouteType::SIM, NetworkParamsType::NONE, NetworkClass::SUB_FREQ},
+    {"uns_system", "star system", "Allowed subscription types: [evt]",
+     NetworkMethodType::UNS_SYSTEM, NetworkRouteType::SIM, NetworkParamsType::STRING, NetworkClass::EVT}
+}};
+
+//--- Compile-time perfect hash of method names ---//
+//
+// A seed for FNV-1a is searched at compile time, so that all method names
+// map to distinct slots of a small table. Lookup is a single hash, one
+// table access and one string comparison.
+
+// Sparse enough to keep the compile-time seed search short
+constexpr std::size_t NETWORK_METHOD_SLOTS = 64;
+static_assert((NETWORK_METHOD_SLOTS & (NETWORK_METHOD_SLOTS-1)) == 0, "Number of slots must be a power of 2");
+static_assert(NETWORK_METHOD_SLOTS >= NETWORK_METHODS.size(), "Too few slots for network methods");
+
+constexpr std::uint32_t hashNetworkMethod(std::string_view _s, std::uint32_t _Seed)
+{
+    std::uint32_t h = 2166136261u ^ _Seed;
+    for (auto c : _s)
+    {
+        h ^= std::uint8_t(c);
+        h *= 16777619u;
+    }
+    // Final avalanche, low bits of FNV-1a only depend on low bits of input
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+constexpr bool isPerfectNetworkMethodSeed(std::uint32_t _Seed)
+{
+    bool IsUsed[NETWORK_METHOD_SLOTS]{};
+    for (const auto& m : NETWORK_METHODS)
+    {
+        const auto i = hashNetworkMethod(m.Name, _Seed) & (NETWORK_METHOD_SLOTS-1);
+        if (IsUsed[i]) return false;
+        IsUsed[i] = true;
+    }
+    return true;
+}
+
+constexpr std::uint32_t findNetworkMethodSeed()
+{
+    std::uint32_t Seed{0};
+    while (!isPerfectNetworkMethodSeed(Seed)) ++Seed;
+    return Seed;
+}
+
+constexpr std::uint32_t NETWORK_METHOD_SEED = findNetworkMethodSeed();
+
+constexpr std::array<std::int8_t, NETWORK_METHOD_SLOTS> buildNetworkMethodSlots()
+{
+    std::array<std::int8_t, NETWORK_METHOD_SLOTS> Slots{};
+    for (auto& s : Slots) s = -1;
+    for (auto i=0u; i<NETWORK_METHODS.size(); ++i)
+    {
+        Slots[hashNetworkMethod(NETWORK_METHODS[i].Name, NETWORK_METHOD_SEED) & (NETWORK_METHOD_SLOTS-1)] = std::int8_t(i);
+    }
+    return Slots;
+}
+
+constexpr std::array<std::int8_t, NETWORK_METHOD_SLOTS> NETWORK_METHOD_TABLE = buildNetworkMethodSlots();
+
+constexpr const NetworkMethodEntry* lookupNetworkMethod(std::string_view _Name)
+{
+    const auto Slot = NETWORK_METHOD_TABLE[hashNetworkMethod(_Name, NETWORK_METHOD_SEED) & (NETWORK_METHOD_SLOTS-1)];
+    if (Slot >= 0 && NETWORK_METHODS[Slot].Name == _Name) return &NETWORK_METHODS[Slot];
+    return nullptr;
+}
+
+static_assert(lookupNetworkMethod("cmd_shutdown")->Method == NetworkMethodType::CMD_SHUTDOWN, "Method lookup broken");
+static_assert(lookupNetworkMethod("uns_sim_stats")->Method == NetworkMethodType::UNS_SIM_STATS, "Method lookup broken");
+static_assert(lookupNetworkMethod("cmd_unknown") == nullptr, "Method lookup broken");
+
+constexpr NetworkMessageClassificationType toNetworkClassification(std::string_view _s)
+{
+    if (_s == "evt") return NetworkMessageClassificationType::EVT;
+    if (_s == "s01") return NetworkMessageClassificationType::S01;
+    if (_s == "s05") return NetworkMessageClassificationType::S05;
+    if (_s == "s1")  return NetworkMessageClassificationType::S1;
+    if (_s == "s5")  return NetworkMessageClassificationType::S5;
+    if (_s == "s10") return NetworkMessageClassificationType::S10;
+    return NetworkMessageClassificationType::INVALID;
+}
+
+constexpr std::uint8_t toNetworkClassBit(NetworkMessageClassificationType _c)
+{
+    switch (_c)
+    {
+        case NetworkMessageClassificationType::CMD: return NetworkClass::CMD;
+        case NetworkMessageClassificationType::EVT: return NetworkClass::EVT;
+        case NetworkMessageClassificationType::S01: return NetworkClass::S01;
+        case NetworkMessageClassificationType::S05: return NetworkClass::S05;
+        case NetworkMessageClassificationType::S1:  return NetworkClass::S1;
+        case NetworkMessageClassificationType::S5:  return NetworkClass::S5;
+        case NetworkMessageClassificationType::S10: return NetworkClass::S10;
+        default: return 0u;
+    }
+}
+
+#endif // NETWORK_COMMAND_HPP
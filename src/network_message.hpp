@@ -4,6 +4,7 @@
 #include <entt/entity/entity.hpp>
 #include <rapidjson/document.h>
 
+#include <cstdint>
 #include <string>
 
 enum class NetworkMessageClassificationType : int
@@ -18,26 +19,41 @@ enum class NetworkMessageClassificationType : int
     S10  // Subscription, each 10.0s, 0.1 Hz
 };
 
-// JSON message
-struct NetworkMessage
+// Topic of outgoing messages, used for statistics
+enum class NetworkTopicType : std::uint8_t
 {
-    entt::entity ClientID;
-    std::string Payload;
+    RESPONSE,
+    DYNAMIC_DATA,
+    GALAXY_DATA,
+    GALAXY_DENSITY,
+    PARTICLE_DATA,
+    PERF_STATS,
+    SIM_STATS,
+    TIRE_DATA,
+    COUNT
 };
 
-// JSON message parsed into rapidjson::Document
-struct NetworkMessageParsed
+constexpr const char* NETWORK_TOPIC_NAMES[std::size_t(NetworkTopicType::COUNT)] =
+{
+    "response", "dynamic_data", "galaxy_data", "galaxy_density", "particle_data", "perf_stats", "sim_stats", "tire_data"
+};
+
+// JSON message, or binary data if flagged (sent as binary frame)
+struct NetworkMessage
 {
     entt::entity ClientID;
-    std::shared_ptr<rapidjson::Document> Payload;
+    std::string Payload;
+    NetworkTopicType Topic{NetworkTopicType::RESPONSE};
+    bool IsBinary{false};
 };
 
-// JSON message classified by JSONRPC message type (command, subscription,...)
-struct NetworkMessageClassified
+// JSON message parsed into a pooled rapidjson document. The payload is only
+// valid while the message is processed, since document and string buffer
+// (in-situ parsing) are recycled afterwards.
+struct NetworkMessageParsed
 {
     entt::entity ClientID;
-    NetworkMessageClassificationType Class;
-    std::shared_ptr<rapidjson::Document> Payload;
+    const rapidjson::Value* Payload{nullptr};
 };
 
 #endif // NETWORK_MESSAGE_HPP
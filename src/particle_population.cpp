@@ -0,0 +1,129 @@
+#include "particle_population.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "binary_frame.hpp"
+#include "grid_bounds.hpp"
+
+namespace
+{
+    constexpr char PARTICLE_FRAME_MAGIC[4] = {'P', 'W', 'P', 'P'};
+    constexpr char PARTICLE_DENSITY_FRAME_MAGIC[4] = {'P', 'W', 'P', 'D'};
+
+    constexpr double G{6.6743e-11};
+
+    // Plummer softening instead of the clamping of GravitySystem, which
+    // keeps the kernel free of branches. It is negligible at distances of
+    // belts and rings.
+    constexpr double SOFTENING_SQR{1.0e6};
+
+    // Velocity change of all particles by one source. Kept separate with
+    // restricted pointers, so that the loop is vectorised.
+    void kick(std::size_t _n, const double* __restrict _X, const double* __restrict _Y,
+              double* __restrict _VX, double* __restrict _VY, const ParticleSource& _s, double _Step)
+    {
+        const double k = G * _s.m * _Step;
+        for (std::size_t i=0; i<_n; ++i)
+        {
+            const double dx = _X[i] - _s.x;
+            const double dy = _Y[i] - _s.y;
+            const double r2 = dx*dx + dy*dy + SOFTENING_SQR;
+            const double f = k / (r2*std::sqrt(r2));
+            _VX[i] -= f*dx;
+            _VY[i] -= f*dy;
+        }
+    }
+
+    void drift(std::size_t _n, double* __restrict _X, double* __restrict _Y,
+               const double* __restrict _VX, const double* __restrict _VY, double _Step)
+    {
+        for (std::size_t i=0; i<_n; ++i)
+        {
+            _X[i] += _VX[i]*_Step;
+            _Y[i] += _VY[i]*_Step;
+        }
+    }
+}
+
+void ParticlePopulation::addBelt(std::uint32_t _Seed, std::uint32_t _n, const Vec2Dd& _Centre, const Vec2Dd& _Velocity,
+                                 double _Mass, double _RadiusMin, double _RadiusMax)
+{
+    std::mt19937 Generator(_Seed);
+    // Uniform in area, i.e. surface density is constant over the belt
+    std::uniform_real_distribution<double> DistRadiusSqr(_RadiusMin*_RadiusMin, _RadiusMax*_RadiusMax);
+    std::uniform_real_distribution<double> DistPhi(0.0, 2.0*MATH_PI);
+    // Slightly eccentric orbits
+    std::normal_distribution<double> DistSpeed(1.0, 0.02);
+
+    const auto n = X_.size() + _n;
+    X_.reserve(n);
+    Y_.reserve(n);
+    VX_.reserve(n);
+    VY_.reserve(n);
+    for (auto i=0u; i<_n; ++i)
+    {
+        const auto r = std::sqrt(DistRadiusSqr(Generator));
+        const auto Phi = DistPhi(Generator);
+        const auto v = std::sqrt(G*_Mass/r) * DistSpeed(Generator);
+        const auto c = std::cos(Phi);
+        const auto s = std::sin(Phi);
+        X_.push_back(_Centre(0) + r*c);
+        Y_.push_back(_Centre(1) + r*s);
+        VX_.push_back(_Velocity(0) - v*s);
+        VY_.push_back(_Velocity(1) + v*c);
+    }
+}
+
+void ParticlePopulation::integrate(const ParticleSource* _Sources, std::size_t _NumberOfSources, double _Step)
+{
+    for (auto j=0u; j<_NumberOfSources; ++j)
+    {
+        kick(X_.size(), X_.data(), Y_.data(), VX_.data(), VY_.data(), _Sources[j], _Step);
+    }
+    drift(X_.size(), X_.data(), Y_.data(), VX_.data(), VY_.data(), _Step);
+}
+
+std::string ParticlePopulation::getFrame(entt::entity _System, std::uint32_t _RequestID) const
+{
+    std::string Frame;
+    Frame.reserve(sizeof(PARTICLE_FRAME_MAGIC) + 3*sizeof(std::uint32_t) + X_.size()*2*sizeof(float));
+    Frame.append(PARTICLE_FRAME_MAGIC, sizeof(PARTICLE_FRAME_MAGIC));
+    appendBinary(Frame, _RequestID);
+    appendBinary(Frame, entt::to_integral(_System));
+    appendBinary(Frame, std::uint32_t(X_.size()));
+    // Single precision is sufficient for display, about 25km at 3AU
+    for (auto x : X_) appendBinary(Frame, float(x));
+    for (auto y : Y_) appendBinary(Frame, float(y));
+    return Frame;
+}
+
+std::string ParticlePopulation::getDensityFrame(entt::entity _System, std::uint32_t _RequestID,
+                                                std::uint32_t _Cells) const
+{
+    // Square around the system's centre, so belts and rings are centred
+    const auto Bounds = getCentredGridBounds(X_.size(), [this](auto i){return X_[i];},
+                                                        [this](auto i){return Y_[i];});
+    const auto Extent = 0.5*Bounds.Extent;
+
+    std::vector<std::uint32_t> Counts(std::size_t(_Cells)*_Cells, 0);
+    const auto Scale = _Cells / Bounds.Extent;
+    for (auto i=0u; i<X_.size(); ++i)
+    {
+        const auto x = std::min(std::uint32_t((X_[i]-Bounds.OriginX) * Scale), _Cells-1);
+        const auto y = std::min(std::uint32_t((Y_[i]-Bounds.OriginY) * Scale), _Cells-1);
+        ++Counts[y*_Cells + x];
+    }
+
+    std::string Frame;
+    Frame.reserve(sizeof(PARTICLE_DENSITY_FRAME_MAGIC) + 3*sizeof(std::uint32_t) + sizeof(double) +
+                  Counts.size()*sizeof(std::uint32_t));
+    Frame.append(PARTICLE_DENSITY_FRAME_MAGIC, sizeof(PARTICLE_DENSITY_FRAME_MAGIC));
+    appendBinary(Frame, _RequestID);
+    appendBinary(Frame, entt::to_integral(_System));
+    appendBinary(Frame, _Cells);
+    appendBinary(Frame, Extent);
+    Frame.append(reinterpret_cast<const char*>(Counts.data()), Counts.size()*sizeof(std::uint32_t));
+    return Frame;
+}
@@ -0,0 +1,91 @@
+#ifndef PARTICLE_POPULATION_HPP
+#define PARTICLE_POPULATION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <entt/entity/entity.hpp>
+
+#include "math_types.hpp"
+
+// Upper limit of cells per side of density summaries
+constexpr std::uint32_t PARTICLE_DENSITY_CELLS_MAX = 256;
+
+// Massive body acting on particles
+struct ParticleSource
+{
+    double x;
+    double y;
+    double m;
+};
+
+// Massless particles, e.g. asteroid belts and rings, as structure of arrays.
+// Particles aren't entities, they only feel the gravity of the few massive
+// bodies of their star system and don't interact otherwise. Hence, they are
+// integrated in bulk, one tight loop per source, that the compiler can
+// vectorise (see CMakeLists.txt).
+// Positions and velocities are relative to the star system as for bodies.
+//
+// Frame formats (little endian):
+//   Particles: magic "PWPP", request ID (u32), star system (u32), number of
+//   particles n (u32), followed by columns of n values each: x, y (f32, m)
+//   Density:   magic "PWPD", request ID (u32), star system (u32), cells per
+//   side n (u32), half extent (f64, m), n*n particle counts (u32) row by row
+//   starting at (-extent, -extent)
+class ParticlePopulation
+{
+
+    public:
+
+        // Adds _n particles on nearly circular orbits between _RadiusMin and
+        // _RadiusMax around a central body, e.g. a belt around a star or a
+        // ring around a planet
+        void addBelt(std::uint32_t _Seed, std::uint32_t _n, const Vec2Dd& _Centre, const Vec2Dd& _Velocity,
+                     double _Mass, double _RadiusMin, double _RadiusMax);
+
+        // Symplectic Euler as IntegratorSystem: all sources kick, then drift
+        void integrate(const ParticleSource* _Sources, std::size_t _NumberOfSources, double _Step);
+
+        void clear()
+        {
+            X_.clear();
+            Y_.clear();
+            VX_.clear();
+            VY_.clear();
+        }
+
+        std::size_t size() const {return X_.size();}
+
+        Vec2Dd getPosition(std::uint32_t _i) const {return {X_[_i], Y_[_i]};}
+        Vec2Dd getVelocity(std::uint32_t _i) const {return {VX_[_i], VY_[_i]};}
+
+        std::string getFrame(entt::entity _System, std::uint32_t _RequestID) const;
+        std::string getDensityFrame(entt::entity _System, std::uint32_t _RequestID, std::uint32_t _Cells) const;
+
+        // Column-wise, see CheckpointOutputArchive and CheckpointInputArchive
+        template<class Archive> void save(Archive& _Archive) const
+        {
+            _Archive(X_);
+            _Archive(Y_);
+            _Archive(VX_);
+            _Archive(VY_);
+        }
+        template<class Archive> void load(Archive& _Archive)
+        {
+            _Archive(X_);
+            _Archive(Y_);
+            _Archive(VX_);
+            _Archive(VY_);
+        }
+
+    private:
+
+        std::vector<double> X_;
+        std::vector<double> Y_;
+        std::vector<double> VX_;
+        std::vector<double> VY_;
+
+};
+
+#endif // PARTICLE_POPULATION_HPP
@@ -0,0 +1,129 @@
+#include "procedural_galaxy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "math_types.hpp"
+#include "star_definitions.hpp"
+
+namespace
+{
+    // Fraction of stars in the central bulge and its scale, similar to the
+    // center of generateGalaxy
+    constexpr double BULGE_FRACTION{0.4};
+    constexpr double BULGE_SIGMA{0.25e22};
+    constexpr double BULGE_RADIUS{0.5e22};
+
+    // Maximum angle of spiral arms as in generateGalaxy
+    constexpr double ARM_PHI_MAX{4.0 * MATH_PI};
+
+    // Seed of a chunk, neighbouring chunks get uncorrelated sequences
+    std::uint64_t hashChunk(std::uint32_t _Seed, std::int32_t _x, std::int32_t _y)
+    {
+        std::uint64_t h = (std::uint64_t(std::uint32_t(_x)) << 32) | std::uint32_t(_y);
+        h ^= std::uint64_t(_Seed) * 0x9e3779b97f4a7c15ull;
+        // splitmix64 finaliser
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+}
+
+ProceduralGalaxy::ProceduralGalaxy(std::uint32_t _Seed, double _NumberOfStars) :
+    Seed_(_Seed), NumberOfStars_(_NumberOfStars)
+{
+    // Same draws as generateGalaxy, hence, a seed gives the same shape
+    std::mt19937 Generator(_Seed);
+    std::poisson_distribution<int> DistGalaxyArms(4);
+    std::normal_distribution<double> DistGalaxyArmLengthBase(0.15, 0.1);
+    std::normal_distribution<double> DistGalaxyArmScatterBase(0.1, 0.05);
+
+    Arms_ = std::max(DistGalaxyArms(Generator), 2);
+    const auto PhiMin = std::max(DistGalaxyArmLengthBase(Generator), 0.05) * MATH_PI;
+    ArmScatter_ = std::max(DistGalaxyArmScatterBase(Generator), 0.05);
+
+    RadiusMin_ = Alpha_ / ARM_PHI_MAX;
+    RadiusMax_ = Alpha_ / PhiMin;
+
+    // Stars are evenly distributed along Phi of the arms, i.e. their surface
+    // density falls with r^-3. Arms are modulated by a Gaussian of their
+    // angular distance, normalised to a mean of one over a full circle.
+    DiscNormalisation_ = 1.0 / (2.0*MATH_PI * (1.0/RadiusMin_ - 1.0/RadiusMax_));
+    ArmNormalisation_ = std::sqrt(2.0*MATH_PI) / (Arms_ * ArmScatter_);
+}
+
+double ProceduralGalaxy::getDensity(double _x, double _y) const
+{
+    const auto r = std::sqrt(_x*_x + _y*_y);
+    const auto Phi = std::atan2(_y, _x);
+    return NumberOfStars_ * ((1.0-BULGE_FRACTION) * this->getArmDensity(r, Phi) +
+                             BULGE_FRACTION * this->getBulgeDensity(r));
+}
+
+void ProceduralGalaxy::generateChunk(std::int32_t _x, std::int32_t _y, StarTable& _Stars) const
+{
+    std::mt19937_64 Generator(hashChunk(Seed_, _x, _y));
+
+    // Chunks are small compared to arms and bulge, density is evaluated at
+    // the centre only
+    const auto x = (_x+0.5)*GALAXY_CHUNK_SIZE;
+    const auto y = (_y+0.5)*GALAXY_CHUNK_SIZE;
+    const auto Arm = (1.0-BULGE_FRACTION) * this->getArmDensity(std::sqrt(x*x + y*y), std::atan2(y, x));
+    const auto Bulge = BULGE_FRACTION * this->getBulgeDensity(std::sqrt(x*x + y*y));
+    const auto Mean = NumberOfStars_ * (Arm+Bulge) * GALAXY_CHUNK_SIZE * GALAXY_CHUNK_SIZE;
+    if (Mean <= 0.0) return;
+
+    std::poisson_distribution<int> DistCount(Mean);
+    std::uniform_real_distribution<double> DistUniform(0.0, 1.0);
+    std::normal_distribution<double> DistNormal(0.0, 1.0);
+
+    // Distributions are local, the global ones of star definitions keep
+    // state between calls and chunks have to be independent
+    const auto n = DistCount(Generator);
+    _Stars.reserve(_Stars.size() + n);
+    for (auto i=0; i<n; ++i)
+    {
+        const Vec2Dd Position{(_x + DistUniform(Generator)) * GALAXY_CHUNK_SIZE,
+                              (_y + DistUniform(Generator)) * GALAXY_CHUNK_SIZE};
+        const auto r = Position.norm();
+
+        // Stars of the bulge are older and cooler (see generateGalaxy)
+        double r_n{0.0};
+        if (DistUniform(Generator) * (Arm+Bulge) < Bulge)
+            r_n = r / BULGE_RADIUS;
+        else
+            r_n = 1.0 - Alpha_ / r / ARM_PHI_MAX;
+
+        int SpectralClass = (r_n + 0.16*DistNormal(Generator)) * 6;
+        SpectralClass = std::clamp(SpectralClass, 0, 6);
+
+        const auto& m = StarMassDistributionParams[SpectralClass];
+        const auto& t = StarTemperatureDistributionParams[SpectralClass];
+        const auto& s = StarRadiusDistributionParams[SpectralClass];
+        const auto Mass = m.first + m.second*DistNormal(Generator);
+        const auto Temperature = t.first + t.second*DistNormal(Generator);
+        const auto Radius = s.first + s.second*DistNormal(Generator);
+
+        _Stars.add(entt::null, Position, Mass, Radius, SpectralClassE(SpectralClass), Temperature);
+    }
+}
+
+double ProceduralGalaxy::getArmDensity(double _r, double _Phi) const
+{
+    if (_r < RadiusMin_ || _r > RadiusMax_) return 0.0;
+
+    // Angular distance to each arm, arm i is at Alpha/r + 2*pi*i/Arms
+    double Modulation{0.0};
+    for (auto i=0; i<Arms_; ++i)
+    {
+        auto d = std::remainder(_Phi - Alpha_/_r - 2.0*MATH_PI*i/Arms_, 2.0*MATH_PI);
+        Modulation += std::exp(-0.5 * d*d / (ArmScatter_*ArmScatter_));
+    }
+    return DiscNormalisation_ / (_r*_r*_r) * Modulation * ArmNormalisation_;
+}
+
+double ProceduralGalaxy::getBulgeDensity(double _r) const
+{
+    return std::exp(-0.5 * _r*_r / (BULGE_SIGMA*BULGE_SIGMA)) / (2.0*MATH_PI * BULGE_SIGMA*BULGE_SIGMA);
+}
@@ -0,0 +1,52 @@
+#ifndef PROCEDURAL_GALAXY_HPP
+#define PROCEDURAL_GALAXY_HPP
+
+#include <cstdint>
+
+#include "star_table.hpp"
+
+// Edge length of a galaxy chunk in m
+constexpr double GALAXY_CHUNK_SIZE = 1.0e19;
+
+// Galaxy, whose stars are a pure function of the galaxy seed and the chunk
+// coordinates. Hence, chunks can be generated independently, in any order
+// and as often as needed, the galaxy is never materialised as a whole.
+// The shape follows generateGalaxy of the simulation: hyperbolic spiral
+// arms with the same parameters drawn from the seed, and a central bulge.
+// The number of stars of a chunk is Poisson distributed, its mean is given
+// by the (normalised) surface density at the chunk's centre.
+class ProceduralGalaxy
+{
+
+    public:
+
+        explicit ProceduralGalaxy(std::uint32_t _Seed, double _NumberOfStars = 2.0e8);
+
+        // Expected number of stars per m^2
+        double getDensity(double _x, double _y) const;
+
+        // Stars of the given chunk, appended to _Stars. They aren't entities
+        // (entt::null), but identified by chunk and index.
+        void generateChunk(std::int32_t _x, std::int32_t _y, StarTable& _Stars) const;
+
+        std::uint32_t getSeed() const {return Seed_;}
+
+    private:
+
+        double getArmDensity(double _r, double _Phi) const;
+        double getBulgeDensity(double _r) const;
+
+        std::uint32_t Seed_{0};
+        double NumberOfStars_{0.0};
+
+        int    Arms_{4};
+        double Alpha_{1.0e22};      // Spiral r = Alpha / Phi
+        double RadiusMin_{0.0};
+        double RadiusMax_{0.0};
+        double ArmScatter_{0.1};    // Relative width of arms
+        double ArmNormalisation_{1.0};
+        double DiscNormalisation_{1.0};
+
+};
+
+#endif // PROCEDURAL_GALAXY_HPP
@@ -1,3 +1,5 @@
+#include <atomic>
+#include <csignal>
 #include <iostream>
 #include <sstream>
 
@@ -6,27 +8,54 @@
 #include <entt/entity/registry.hpp>
 #include <rapidjson/document.h>
 
+#include "checkpoint_manager.hpp"
+#include "command_buffer.hpp"
+#include "galaxy_chunk_manager.hpp"
+#include "input_log.hpp"
 #include "json_manager.hpp"
 #include "message_handler.hpp"
+#include "metrics_manager.hpp"
 #include "network_manager.hpp"
 #include "network_message_broker.hpp"
 #include "position_component.hpp"
+#include "publisher_manager.hpp"
 #include "simulation_manager.hpp"
 #include "subscription_components.hpp"
+#include "trace.hpp"
 #include "velocity_component.hpp"
 
 int PWNG_ABORT_STARTUP = -1;
 
+// Set by SIGUSR1, trace is dumped by main thread
+std::atomic_bool IsTraceDumpRequested{false};
+
+void requestTraceDump(int)
+{
+    IsTraceDumpRequested = true;
+}
+
 auto parseArguments(int argc, char* argv[], entt::registry& _Reg)
 {
     argagg::parser ArgParser
         {{
+            {"checkpoint", {"-c", "--checkpoint"},
+             "Writes checkpoints to given file, periodically, on cmd_save_checkpoint and on shutdown", 1},
+            {"checkpoint_interval", {"--checkpoint-interval"},
+             "Seconds between periodic checkpoints, 0 disables (default: 300)", 1},
             {"debug", {"-d", "--debug"},
              "debug level (0-3)", 1},
             {"help", {"-h", "--help"},
              "Shows this help message", 0},
             {"port", {"-p", "--port"},
-             "Port to listen to", 1}
+             "Port to listen to", 1},
+            {"record", {"-r", "--record"},
+             "Records simulation input to given file", 1},
+            {"replay", {"--replay"},
+             "Replays recorded input without network as fast as possible", 1},
+            {"restore", {"--restore"},
+             "Restores world from given checkpoint", 1},
+            {"trace", {"-t", "--trace"},
+             "Enables tracing, dump by cmd_dump_trace or SIGUSR1", 0}
         }};
 
     MessageHandler::ReportLevelType DebugLevel = MessageHandler::INFO;
@@ -56,6 +85,49 @@ auto parseArguments(int argc, char* argv[], entt::registry& _Reg)
         Port = Args["port"];
     }
 
+    if (Args["checkpoint"])
+    {
+        const auto FileName = Args["checkpoint"].as<std::string>();
+        _Reg.ctx<CheckpointManager>().setFileName(FileName, Args["checkpoint_interval"].as<double>(300.0));
+        _Reg.ctx<MessageHandler>().report("prg", "Writing checkpoints to "+FileName, MessageHandler::INFO);
+    }
+    if (Args["restore"])
+    {
+        _Reg.ctx<CheckpointManager>().setRestoreFileName(Args["restore"].as<std::string>());
+    }
+
+    if (Args["record"] && Args["replay"])
+    {
+        _Reg.ctx<MessageHandler>().report("prg", "Recording and replaying input are exclusive");
+        return std::tie(PWNG_ABORT_STARTUP, DebugLevel);
+    }
+    if (Args["record"])
+    {
+        const auto FileName = Args["record"].as<std::string>();
+        if (!_Reg.set<InputLogWriter>(FileName).isOpen())
+        {
+            _Reg.ctx<MessageHandler>().report("prg", "Couldn't open input log "+FileName+" for writing");
+            return std::tie(PWNG_ABORT_STARTUP, DebugLevel);
+        }
+        _Reg.ctx<MessageHandler>().report("prg", "Recording input to "+FileName, MessageHandler::INFO);
+    }
+    if (Args["replay"])
+    {
+        const auto FileName = Args["replay"].as<std::string>();
+        if (!_Reg.set<InputLogReader>(FileName).isOpen())
+        {
+            _Reg.ctx<MessageHandler>().report("prg", "Couldn't read input log "+FileName);
+            return std::tie(PWNG_ABORT_STARTUP, DebugLevel);
+        }
+        _Reg.ctx<MessageHandler>().report("prg", "Replaying input from "+FileName, MessageHandler::INFO);
+    }
+
+    if (Args["trace"])
+    {
+        Tracer::get().setEnabled(true);
+        _Reg.ctx<MessageHandler>().report("prg", "Tracing enabled", MessageHandler::INFO);
+    }
+
     if (Args["debug"])
     {
         int d = Args["debug"];
@@ -74,6 +146,12 @@ int main(int argc, char* argv[])
 {
     using namespace rapidjson;
 
+    // The world registry holds all simulation objects, the client registry
+    // all connections and their subscriptions. Both are owned by the
+    // simulation thread, other threads record structural changes in the
+    // command buffer of the accordant registry.
+    // Clients have to outlive the managers stored in world's context.
+    entt::registry RegClients;
     entt::registry Reg;
 
     Reg.set<MessageHandler>();
@@ -87,6 +165,9 @@ int main(int argc, char* argv[])
     Messages.registerSource("brk", "brk");
     Messages.setColored(true);
 
+    // Configured by command line arguments
+    Reg.set<CheckpointManager>(Reg);
+
     int Port = 9002;
     MessageHandler::ReportLevelType DebugLevel = MessageHandler::DEBUG_L3;
 
@@ -98,31 +179,70 @@ int main(int argc, char* argv[])
     {
         moodycamel::ConcurrentQueue<NetworkMessage> InputQueue;
         moodycamel::ConcurrentQueue<NetworkMessage> OutputQueue;
-        moodycamel::ConcurrentQueue<NetworkMessageClassified> QueueSimIn;
-        moodycamel::ConcurrentQueue<NetworkMessageParsed> QueueNetIn;
+        moodycamel::ConcurrentQueue<NetworkCommand> QueueSimIn;
+        moodycamel::ConcurrentQueue<NetworkCommand> QueueNetIn;
+
+        Reg.set<CommandBuffer>(Reg);
+        RegClients.set<CommandBuffer>(RegClients);
 
+        Reg.set<GalaxyChunkManager>(Reg);
         Reg.set<JsonManager>(Reg);
-        Reg.set<NetworkManager>(Reg);
-        Reg.set<NetworkMessageBroker>(Reg, &QueueSimIn, &QueueNetIn, &OutputQueue);
-        Reg.set<SimulationManager>(Reg);
+        Reg.set<MetricsManager>(Reg);
+        Reg.set<NetworkManager>(Reg, RegClients);
+        Reg.set<NetworkMessageBroker>(Reg, RegClients, &QueueSimIn, &QueueNetIn, &OutputQueue);
+        Reg.set<SimulationManager>(Reg, RegClients);
+        // Set after simulation, so it outlives the simulation thread
+        Reg.set<PublisherManager>(Reg);
         auto& Broker = Reg.ctx<NetworkMessageBroker>();
         auto& Network = Reg.ctx<NetworkManager>();
         auto& Simulation = Reg.ctx<SimulationManager>();
 
-        if (Network.init(&QueueNetIn, &InputQueue, &OutputQueue, Port))
+        Reg.ctx<MetricsManager>().init(&InputQueue, &OutputQueue, &QueueSimIn, &Simulation.getTickStats());
+
+        // Replay runs without network against the recorded galaxy
+        auto* InputReplay = Reg.try_ctx<InputLogReader>();
+        if (InputReplay != nullptr)
+        {
+            Simulation.setSeed(InputReplay->getSeed());
+            Simulation.setStepSize(InputReplay->getStepSize());
+        }
+
+        if (InputReplay != nullptr || Network.init(&QueueNetIn, &InputQueue, &OutputQueue, Port))
         {
             Timer MainTimer;
 
+            Reg.ctx<PublisherManager>().init(&OutputQueue);
             Simulation.init(&QueueSimIn, &OutputQueue);
+            // Seed might have been restored from a checkpoint
+            Reg.ctx<GalaxyChunkManager>().init(Simulation.getSeed(), Simulation.getRotation());
+
+            TRACE_THREAD("main");
+            std::signal(SIGUSR1, requestTraceDump);
 
-            while (Network.isRunning() || Simulation.isRunning())
+            while ((InputReplay == nullptr && Network.isRunning()) || Simulation.isRunning())
             {
                 MainTimer.start();
 
+                // Without network, outgoing messages are dropped
+                if (InputReplay != nullptr)
+                {
+                    NetworkMessage Message;
+                    while (OutputQueue.try_dequeue(Message)) {}
+                }
+
+                if (IsTraceDumpRequested.exchange(false) && Tracer::isEnabled())
+                {
+                    const auto FileName = Tracer::createFileName();
+                    if (Tracer::get().dump(FileName))
+                        Messages.report("prg", "Trace written to "+FileName, MessageHandler::INFO);
+                    else
+                        Messages.report("prg", "Couldn't write trace to "+FileName);
+                }
+
                 NetworkMessage Message;
                 while (InputQueue.try_dequeue(Message))
                 {
-                    DBLK(Messages.report("prg", "Dequeueing incoming message:\n"+Message.Payload, MessageHandler::DEBUG_L3);)
+                    DBLK(MSG_REPORT(Messages, "prg", "Dequeueing incoming message:\n"+Message.Payload, MessageHandler::DEBUG_L3);)
 
                     Broker.process(Message);
                 }
@@ -133,11 +253,17 @@ int main(int argc, char* argv[])
                 }
                 else
                 {
-                    Messages.report("prg", "Thread processing exceeds step time ("
-                                            + std::to_string(MainTimer.elapsed_ms())
-                                            +"/10.0)ms", MessageHandler::WARNING);
+                    MSG_REPORT(Messages, "prg", "Thread processing exceeds step time ("
+                                                 + std::to_string(MainTimer.elapsed_ms())
+                                                 +"/10.0)ms", MessageHandler::WARNING);
                 }
             }
+
+            // The simulation thread might still write its final checkpoint
+            // and report, it has to finish before any context variable is
+            // destroyed
+            Simulation.shutdown();
+            Simulation.join();
         }
 
         Messages.report("prg", "Exit program", MessageHandler::INFO);
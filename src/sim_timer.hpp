@@ -16,6 +16,7 @@ class SimTimer
         std::uint32_t getMinutesFraction() const;
         double        getSecondsFraction() const;
         double        getSeconds() const;
+        double        getTotalSeconds() const;
         double        getAcceleration() const;
         std::string   toStamp() const;
         
@@ -23,6 +24,7 @@ class SimTimer
 
         void fromStamp(const std::string& _s);
         void inc(const double& _Seconds);
+        void set(std::uint32_t _Years, double _Seconds, bool _IsActive);
         void setAcceleration(double _a);
         void start();
         void stop();
@@ -74,6 +76,12 @@ inline double SimTimer::getSeconds() const
     return Seconds_;
 }
 
+inline double SimTimer::getTotalSeconds() const
+{
+    constexpr double S_PER_Y = 365.0*24.0*60.0*60.0;
+    return Years_ * S_PER_Y + Seconds_;
+}
+
 inline double SimTimer::getAcceleration() const
 {
     return Acceleration_;
@@ -89,6 +97,13 @@ inline bool SimTimer::isActive() const
     return Active_;
 }
 
+inline void SimTimer::set(std::uint32_t _Years, double _Seconds, bool _IsActive)
+{
+    Years_ = _Years;
+    Seconds_ = _Seconds;
+    Active_ = _IsActive;
+}
+
 inline void SimTimer::setAcceleration(double _a)
 {
     Acceleration_ = _a;
@@ -18,8 +18,9 @@ enum class SpectralClassE : int
     O = 6
 };
 
-constexpr double SOLAR_MASSES{6.96342e8};
+constexpr double SOLAR_MASSES{1.98847e30};
 constexpr double SOLAR_RADIUS{6.957e8};
+constexpr double SOLAR_TEMPERATURE{5772.0};   // Effective temperature
 
 // Parameters for random distributions
 // Normal distribution, values are mean and standard deviation
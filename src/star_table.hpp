@@ -0,0 +1,106 @@
+#ifndef STAR_TABLE_HPP
+#define STAR_TABLE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <entt/entity/entity.hpp>
+
+#include "math_types.hpp"
+#include "star_definitions.hpp"
+
+// Static data of stars as structure of arrays. Stars are added while the
+// galaxy is generated, afterwards the table is read-only and the index of a
+// star is stable. Stars still are entities (names, star systems), but
+// serialisation and queries stream through the columns instead of joining
+// several component pools.
+// Positions are kept in double precision, the galaxy spans about 1e22m and
+// float would resolve about 0.1ly only. Everything else fits into float.
+class StarTable
+{
+
+    public:
+
+        std::uint32_t add(entt::entity _e, const Vec2Dd& _Position, double _Mass, double _Radius,
+                          SpectralClassE _SpectralClass, double _Temperature)
+        {
+            IDs_.push_back(_e);
+            X_.push_back(_Position(0));
+            Y_.push_back(_Position(1));
+            Masses_.push_back(float(_Mass));
+            Radii_.push_back(float(_Radius));
+            Temperatures_.push_back(float(_Temperature));
+            SpectralClasses_.push_back(std::uint8_t(_SpectralClass));
+            return std::uint32_t(IDs_.size()-1);
+        }
+
+        void reserve(std::size_t _n)
+        {
+            IDs_.reserve(_n);
+            X_.reserve(_n);
+            Y_.reserve(_n);
+            Masses_.reserve(_n);
+            Radii_.reserve(_n);
+            Temperatures_.reserve(_n);
+            SpectralClasses_.reserve(_n);
+        }
+
+        void clear()
+        {
+            IDs_.clear();
+            X_.clear();
+            Y_.clear();
+            Masses_.clear();
+            Radii_.clear();
+            Temperatures_.clear();
+            SpectralClasses_.clear();
+        }
+
+        std::size_t size() const {return IDs_.size();}
+
+        entt::entity   getID(std::uint32_t _i) const {return IDs_[_i];}
+        Vec2Dd         getPosition(std::uint32_t _i) const {return {X_[_i], Y_[_i]};}
+        const double*  getXs() const {return X_.data();}
+        const double*  getYs() const {return Y_.data();}
+        double         getX(std::uint32_t _i) const {return X_[_i];}
+        double         getY(std::uint32_t _i) const {return Y_[_i];}
+        float          getMass(std::uint32_t _i) const {return Masses_[_i];}
+        float          getRadius(std::uint32_t _i) const {return Radii_[_i];}
+        float          getTemperature(std::uint32_t _i) const {return Temperatures_[_i];}
+        SpectralClassE getSpectralClass(std::uint32_t _i) const {return SpectralClassE(SpectralClasses_[_i]);}
+
+        // Column-wise, see CheckpointOutputArchive and CheckpointInputArchive
+        template<class Archive> void save(Archive& _Archive) const
+        {
+            _Archive(IDs_);
+            _Archive(X_);
+            _Archive(Y_);
+            _Archive(Masses_);
+            _Archive(Radii_);
+            _Archive(Temperatures_);
+            _Archive(SpectralClasses_);
+        }
+        template<class Archive> void load(Archive& _Archive)
+        {
+            _Archive(IDs_);
+            _Archive(X_);
+            _Archive(Y_);
+            _Archive(Masses_);
+            _Archive(Radii_);
+            _Archive(Temperatures_);
+            _Archive(SpectralClasses_);
+        }
+
+    private:
+
+        std::vector<entt::entity>   IDs_;
+        std::vector<double>         X_;
+        std::vector<double>         Y_;
+        std::vector<float>          Masses_;
+        std::vector<float>          Radii_;
+        std::vector<float>          Temperatures_;
+        std::vector<std::uint8_t>   SpectralClasses_;
+
+};
+
+#endif // STAR_TABLE_HPP
@@ -1,7 +1,8 @@
 #ifndef GRAVITY_SYSTEM_HPP
 #define GRAVITY_SYSTEM_HPP
 
-#include <iostream>
+#include <cmath>
+#include <vector>
 
 #include <entt/entity/registry.hpp>
 
@@ -19,7 +20,10 @@ class GravitySystem
 
         explicit GravitySystem(entt::registry& _Reg) : Reg_(_Reg) {}
 
-        void calculateForces()
+        // If ordered by KinematicOrderSystem, members of each system are
+        // read as a contiguous range of the kinematic group. Otherwise,
+        // e.g. after structural changes, they are looked up one by one.
+        void calculateForces(bool _IsOrdered = false)
         {
             Reg_.view<AccelerationComponent>().each
             (
@@ -28,43 +32,129 @@ class GravitySystem
                     _a.v = {0.0, 0.0};
                 }
             );
+            if (_IsOrdered)
+            {
+                this->calculateForcesOrdered();
+                return;
+            }
             Reg_.view<StarSystemComponent>().each(
                 [this](auto _e, const auto& _StarSystem)
                 {
-                    for (auto i=0u; i<_StarSystem.Objects.size(); ++i)
+                    // Generated systems only hold a static star (see
+                    // StarTable), there is nothing to interact with
+                    if (_StarSystem.Objects.size() < 2) return;
+
+                    // Only gravitators are sources of gravity, they
+                    // interact pairwise. All other objects are test
+                    // particles, feeling gravity of the sources without
+                    // producing it, which is O(N*M) instead of O(N^2).
+                    Sources_.clear();
+                    for (auto e : _StarSystem.Objects)
                     {
-                        auto& a_i = Reg_.get<AccelerationComponent>(_StarSystem.Objects[i]);
-                        const auto& b_i = Reg_.get<BodyComponent>(_StarSystem.Objects[i]);
-                        const auto& p_i = Reg_.get<PositionComponent>(_StarSystem.Objects[i]);
+                        if (Reg_.has<GravitatorComponent>(e))
+                            Sources_.push_back({e, Reg_.get<PositionComponent>(e).v, Reg_.get<BodyComponent>(e).m});
+                    }
+
+                    this->interactSources();
 
-                        for (auto j=i+1; j<_StarSystem.Objects.size(); ++j)
+                    if (Sources_.empty()) return;
+                    for (auto e : _StarSystem.Objects)
+                    {
+                        if (Reg_.has<GravitatorComponent>(e)) continue;
+
+                        auto& a = Reg_.get<AccelerationComponent>(e);
+                        const auto& p = Reg_.get<PositionComponent>(e);
+                        for (const auto& s : Sources_)
                         {
-                            auto& a_j = Reg_.get<AccelerationComponent>(_StarSystem.Objects[j]);
-                            const auto& b_j = Reg_.get<BodyComponent>(_StarSystem.Objects[j]);
-                            const auto& p_j = Reg_.get<PositionComponent>(_StarSystem.Objects[j]);
+                            a.v -= this->getFieldFactor(p.v - s.p) * s.m;
+                        }
+                    }
+                }
+            );
+        }
 
-                            Vec2Dd Diff = (p_i.v - p_j.v);
-                            double Rsqr = Diff.squaredNorm();
+    private:
 
-                            if (Rsqr < 1.0e6) Rsqr = 1.0e6;
+        void calculateForcesOrdered()
+        {
+            auto Group = Reg_.group<VelocityComponent, PositionComponent>(
+                                    entt::get<AccelerationComponent, BodyComponent>);
+            Reg_.view<StarSystemComponent>().each(
+                [this, &Group](auto, const auto& _StarSystem)
+                {
+                    if (_StarSystem.Count < 2) return;
 
-                            Vec2Dd d = Diff / std::sqrt(Rsqr);
+                    const auto First = Group.begin() + _StarSystem.Offset;
+                    const auto Last = First + _StarSystem.Count;
 
-                            constexpr double G = 6.6743e-11;
-                            Vec2Dd Tmp  = G / Rsqr * d;
+                    Sources_.clear();
+                    for (auto it = First; it != Last; ++it)
+                    {
+                        if (Reg_.has<GravitatorComponent>(*it))
+                            Sources_.push_back({*it, Group.template get<PositionComponent>(*it).v,
+                                                     Group.template get<BodyComponent>(*it).m});
+                    }
+
+                    this->interactSources();
+
+                    if (Sources_.empty()) return;
+                    for (auto it = First; it != Last; ++it)
+                    {
+                        if (Reg_.has<GravitatorComponent>(*it)) continue;
 
-                            a_i.v -= Tmp * b_j.m;
-                            a_j.v += Tmp * b_i.m;
+                        auto [a, p] = Group.template get<AccelerationComponent, PositionComponent>(*it);
+                        for (const auto& s : Sources_)
+                        {
+                            a.v -= this->getFieldFactor(p.v - s.p) * s.m;
                         }
                     }
                 }
             );
         }
 
-    private:
+        // Pairwise, sources of the current system
+        void interactSources()
+        {
+            for (auto i=0u; i<Sources_.size(); ++i)
+            {
+                auto& a_i = Reg_.get<AccelerationComponent>(Sources_[i].ID);
+
+                for (auto j=i+1; j<Sources_.size(); ++j)
+                {
+                    auto& a_j = Reg_.get<AccelerationComponent>(Sources_[j].ID);
+
+                    const Vec2Dd Tmp = this->getFieldFactor(Sources_[i].p - Sources_[j].p);
+
+                    a_i.v -= Tmp * Sources_[j].m;
+                    a_j.v += Tmp * Sources_[i].m;
+                }
+            }
+        }
+
+        struct Source
+        {
+            entt::entity ID;
+            Vec2Dd p;
+            double m;
+        };
+
+        // G / r^2 in direction of _Diff, the difference of positions
+        static Vec2Dd getFieldFactor(const Vec2Dd& _Diff)
+        {
+            double Rsqr = _Diff.squaredNorm();
+
+            if (Rsqr < 1.0e6) Rsqr = 1.0e6;
+
+            Vec2Dd d = _Diff / std::sqrt(Rsqr);
+
+            constexpr double G = 6.6743e-11;
+            return G / Rsqr * d;
+        }
 
         entt::registry& Reg_;
 
+        std::vector<Source> Sources_;   // Of the current system
+
 };
 
 #endif // GRAVITY_SYSTEM_HPP
@@ -14,6 +14,8 @@ class IntegratorSystem
 
         explicit IntegratorSystem(entt::registry& _Reg) : Reg_(_Reg) {}
 
+        // Both groups see entities in the order of KinematicOrderSystem,
+        // velocities are streamed twice in the same sequence
         void integrate(const double _Step) const
         {
             auto GroupAV = Reg_.group<AccelerationComponent>(entt::get<VelocityComponent>);
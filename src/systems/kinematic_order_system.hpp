@@ -0,0 +1,129 @@
+#ifndef KINEMATIC_ORDER_SYSTEM_HPP
+#define KINEMATIC_ORDER_SYSTEM_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+#include "acceleration_component.hpp"
+#include "body_component.hpp"
+#include "position_component.hpp"
+#include "sim_components.hpp"
+#include "velocity_component.hpp"
+
+// Sorts the pools of kinematic components (acceleration, velocity, position,
+// body) by star system, so that the members of each system are contiguous
+// in the kinematic group. Offset and count of each system's members are
+// stored in StarSystemComponent. Hence, GravitySystem streams through the
+// pools instead of jumping between entities, and both loops of
+// IntegratorSystem see the same order.
+// Adding or removing kinematic components or star systems invalidates the
+// order, it is restored by the next call of sort(). Changing the objects of
+// a star system requires invalidate().
+class KinematicOrderSystem
+{
+
+    public:
+
+        explicit KinematicOrderSystem(entt::registry& _Reg) : Reg_(_Reg)
+        {
+            this->connect<AccelerationComponent>();
+            this->connect<BodyComponent>();
+            this->connect<PositionComponent>();
+            this->connect<StarSystemComponent>();
+            this->connect<VelocityComponent>();
+        }
+        ~KinematicOrderSystem()
+        {
+            this->disconnect<AccelerationComponent>();
+            this->disconnect<BodyComponent>();
+            this->disconnect<PositionComponent>();
+            this->disconnect<StarSystemComponent>();
+            this->disconnect<VelocityComponent>();
+        }
+        KinematicOrderSystem(const KinematicOrderSystem&) = delete;
+        KinematicOrderSystem& operator=(const KinematicOrderSystem&) = delete;
+
+        bool isOrdered() const {return IsOrdered_;}
+        void invalidate() {IsOrdered_ = false;}
+
+        // Modifies the registry, hence, not while systems are running
+        void sort()
+        {
+            // Key of each entity: star system and index among its objects,
+            // entities without system go last
+            constexpr auto Mask = entt::entt_traits<entt::entity>::entity_mask;
+            Keys_.assign(Reg_.size(), std::numeric_limits<std::uint64_t>::max());
+            Systems_.clear();
+            Reg_.view<StarSystemComponent>().each(
+                [this](auto _e, const auto& _StarSystem)
+                {
+                    const std::uint64_t s = Systems_.size();
+                    for (auto i=0u; i<_StarSystem.Objects.size(); ++i)
+                    {
+                        const auto e = std::size_t(entt::to_integral(_StarSystem.Objects[i]) & Mask);
+                        if (e < Keys_.size()) Keys_[e] = (s << 32) | i;
+                    }
+                    Systems_.push_back(_e);
+                });
+            auto Compare = [this](const entt::entity _l, const entt::entity _r)
+            {
+                return Keys_[entt::to_integral(_l) & Mask] < Keys_[entt::to_integral(_r) & Mask];
+            };
+
+            // Velocity and position are owned by the kinematic group, which
+            // is the most restrictive of its family. Acceleration is owned
+            // by its own group, body isn't owned.
+            auto GroupVPAB = Reg_.group<VelocityComponent, PositionComponent>(
+                                        entt::get<AccelerationComponent, BodyComponent>);
+            auto GroupAV = Reg_.group<AccelerationComponent>(entt::get<VelocityComponent>);
+            GroupVPAB.sort(Compare);
+            GroupAV.sort(Compare);
+            Reg_.sort<BodyComponent>(Compare);
+
+            // Members of a system are contiguous now
+            Reg_.view<StarSystemComponent>().each(
+                [](auto, auto& _StarSystem)
+                {
+                    _StarSystem.Offset = 0;
+                    _StarSystem.Count = 0;
+                });
+            std::uint32_t k{0};
+            for (auto e : GroupVPAB)
+            {
+                const auto System = Keys_[entt::to_integral(e) & Mask] >> 32;
+                if (System < Systems_.size())
+                {
+                    auto& StarSystem = Reg_.get<StarSystemComponent>(Systems_[System]);
+                    if (StarSystem.Count++ == 0) StarSystem.Offset = k;
+                }
+                ++k;
+            }
+            IsOrdered_ = true;
+        }
+
+    private:
+
+        template<class T> void connect()
+        {
+            Reg_.on_construct<T>().template connect<&KinematicOrderSystem::onChange>(*this);
+            Reg_.on_destroy<T>().template connect<&KinematicOrderSystem::onChange>(*this);
+        }
+        template<class T> void disconnect()
+        {
+            Reg_.on_construct<T>().template disconnect<&KinematicOrderSystem::onChange>(*this);
+            Reg_.on_destroy<T>().template disconnect<&KinematicOrderSystem::onChange>(*this);
+        }
+        void onChange(entt::registry&, entt::entity) {IsOrdered_ = false;}
+
+        entt::registry& Reg_;
+
+        std::vector<std::uint64_t> Keys_;       // By entity, system and index
+        std::vector<entt::entity>  Systems_;    // By index of system
+        bool IsOrdered_{false};
+
+};
+
+#endif // KINEMATIC_ORDER_SYSTEM_HPP
@@ -1,12 +1,15 @@
 #ifndef NAME_SYSTEM_HPP
 #define NAME_SYSTEM_HPP
 
+#include <memory>
 #include <string>
-#include <unordered_map>
 
 #include <entt/entity/registry.hpp>
 
 #include "name_component.hpp"
+#include "name_index.hpp"
+#include "name_index_manager.hpp"
+#include "sim_components.hpp"
 
 class NameSystem
 {
@@ -28,14 +31,78 @@ class NameSystem
             {
                 strcpy(CompName.Name, _Name.c_str());
             }
-            MapToEntityId_.insert({_Name, entt::to_integral(_e)});
+            Reg_.remove_if_exists<ProceduralNameComponent>(_e);
+            IsChanged_ = true;
         }
 
+        // Generated objects only store type and index, the name is derived
+        // when needed
+        void setProceduralName(entt::entity _e, ProceduralNameType _Type, std::uint32_t _Index)
+        {
+            Reg_.emplace_or_replace<ProceduralNameComponent>(_e, _Type, _Index);
+            IsChanged_ = true;
+        }
+
+        // Forces a rebuild of the index, e.g. after loading a snapshot
+        void invalidate() {IsChanged_ = true;}
+
+        // Writes the name of _e to _Name (NAME_SIZE_MAX), returns its length
+        std::size_t getName(entt::entity _e, char* _Name) const
+        {
+            if (const auto* n = Reg_.try_get<NameComponent>(_e))
+            {
+                std::memcpy(_Name, n->Name, NAME_SIZE_MAX);
+                return std::strlen(_Name);
+            }
+            if (const auto* p = Reg_.try_get<ProceduralNameComponent>(_e))
+            {
+                return toName(*p, _Name);
+            }
+            std::strcpy(_Name, "Unknown");
+            return 7;
+        }
+
+        static std::size_t toName(const ProceduralNameComponent& _p, char* _Name)
+        {
+            return toProceduralName(_p, _Name);
+        }
+
+        // Collects all names if they changed since the last call, the index
+        // is built in the background (see NameIndexManager). Called by the
+        // simulation thread, readers keep the index they got until they are
+        // done.
+        void publish()
+        {
+            if (!IsChanged_) return;
+
+            auto Index = std::make_unique<NameIndex>();
+            Reg_.view<NameComponent>().each(
+                [this, &Index](auto _e, const auto& _n)
+                {
+                    Index->add(_e, _n.Name, Reg_.has<StarSystemComponent>(_e));
+                });
+            // Only type and index, names are derived by the index
+            Reg_.view<ProceduralNameComponent>().each(
+                [&Index](auto _e, const auto& _p)
+                {
+                    Index->addProcedural(_e, _p);
+                });
+            Indexer_.submit(std::move(Index));
+            IsChanged_ = false;
+        }
+
+        // Any thread, nullptr if not published yet
+        std::shared_ptr<const NameIndex> getIndex() const {return Indexer_.get();}
+
+        // Blocks until published names are indexed
+        void wait() {Indexer_.wait();}
+
     private:
 
         entt::registry& Reg_;
 
-        std::unordered_map<std::string, entt::id_type> MapToEntityId_;
+        NameIndexManager Indexer_;
+        bool IsChanged_{false};
 
 };
 
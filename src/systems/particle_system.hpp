@@ -0,0 +1,61 @@
+#ifndef PARTICLE_SYSTEM_HPP
+#define PARTICLE_SYSTEM_HPP
+
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+#include "body_component.hpp"
+#include "particle_population.hpp"
+#include "position_component.hpp"
+#include "sim_components.hpp"
+
+// Populations are integrated in turns, each tick one slice of them with the
+// time accumulated since their last turn. Orbits of belts and rings take
+// days to years, hence, the larger step doesn't matter.
+constexpr std::uint32_t PARTICLE_POPULATION_SLICES = 16;
+
+class ParticleSystem
+{
+
+    public:
+
+        explicit ParticleSystem(entt::registry& _Reg) : Reg_(_Reg) {}
+
+        void integrate(const double _Step)
+        {
+            auto i = 0u;
+            Reg_.view<ParticlePopulationComponent, StarSystemComponent>().each(
+                [&](auto, auto& _p, const auto& _StarSystem)
+                {
+                    _p.Lag += _Step;
+                    if (i++ % PARTICLE_POPULATION_SLICES != Slice_) return;
+
+                    // Sources are the gravitators of the system (see
+                    // GravitySystem) and the static star of generated systems
+                    Sources_.clear();
+                    if (_p.CentralMass > 0.0) Sources_.push_back({0.0, 0.0, _p.CentralMass});
+                    for (auto e : _StarSystem.Objects)
+                    {
+                        if (!Reg_.has<GravitatorComponent>(e)) continue;
+                        const auto& p = Reg_.get<PositionComponent>(e);
+                        Sources_.push_back({p.v(0), p.v(1), Reg_.get<BodyComponent>(e).m});
+                    }
+
+                    _p.Particles.integrate(Sources_.data(), Sources_.size(), _p.Lag);
+                    _p.Lag = 0.0;
+                }
+            );
+            Slice_ = (Slice_ + 1) % PARTICLE_POPULATION_SLICES;
+        }
+
+    private:
+
+        entt::registry& Reg_;
+
+        std::vector<ParticleSource> Sources_;   // Of the current system
+        std::uint32_t Slice_{0};
+
+};
+
+#endif // PARTICLE_SYSTEM_HPP
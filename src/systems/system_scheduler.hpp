@@ -0,0 +1,173 @@
+#ifndef SYSTEM_SCHEDULER_HPP
+#define SYSTEM_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <entt/core/type_info.hpp>
+
+#include "job_pool.hpp"
+#include "tick_stats.hpp"
+#include "timer.hpp"
+#include "trace.hpp"
+
+// Runs the systems of a tick on the job pool. Each system declares the
+// components (or other shared data) it reads and writes. A system depends
+// on all previously added systems it conflicts with, i.e. if one of them
+// writes what the other one reads or writes. Systems without dependencies
+// among each other run concurrently.
+// Component pools are accessed concurrently, hence, they have to exist
+// before running, creating a pool modifies the registry.
+class SystemScheduler
+{
+
+    public:
+
+        class System
+        {
+
+            public:
+
+                template<class... T> System& reads()
+                {
+                    (Reads_.push_back(entt::type_info<T>::id()), ...);
+                    return *this;
+                }
+                template<class... T> System& writes()
+                {
+                    (Writes_.push_back(entt::type_info<T>::id()), ...);
+                    return *this;
+                }
+
+                // Tick phase to record the duration to
+                System& records(TickPhaseType _Phase) {Phase_ = _Phase; return *this;}
+
+                // Evaluated by the calling thread at the beginning of each
+                // run, skipped systems still keep their position in the
+                // order of dependent systems
+                System& runsIf(std::function<bool()> _Condition) {Condition_ = std::move(_Condition); return *this;}
+
+            private:
+
+                friend class SystemScheduler;
+
+                bool isConflicting(const System& _s) const
+                {
+                    auto Contains = [](const auto& _v, auto _id) {return std::find(_v.begin(), _v.end(), _id) != _v.end();};
+                    for (auto id : Writes_)
+                    {
+                        if (Contains(_s.Reads_, id) || Contains(_s.Writes_, id)) return true;
+                    }
+                    for (auto id : Reads_)
+                    {
+                        if (Contains(_s.Writes_, id)) return true;
+                    }
+                    return false;
+                }
+
+                const char*                 Name_{""};
+                std::function<void()>       Run_;
+                std::function<bool()>       Condition_;
+                std::vector<entt::id_type>  Reads_;
+                std::vector<entt::id_type>  Writes_;
+                TickPhaseType               Phase_{TickPhaseType::COUNT};
+
+                std::vector<std::size_t>    Dependents_;
+                std::size_t                 NumberOfDependencies_{0};
+                std::atomic<std::size_t>    Remaining_{0};
+                double                      Elapsed_{0.0};
+                bool                        IsExecuted_{false};
+        };
+
+        explicit SystemScheduler(JobPool& _Jobs) : Jobs_(_Jobs) {}
+
+        System& add(const char* _Name, std::function<void()> _Run)
+        {
+            auto& s = *Systems_.emplace_back(std::make_unique<System>());
+            s.Name_ = _Name;
+            s.Run_ = std::move(_Run);
+            IsBuilt_ = false;
+            return s;
+        }
+
+        void run()
+        {
+            if (!IsBuilt_) this->build();
+
+            JobCounter Counter;
+            for (auto& s : Systems_)
+            {
+                s->IsExecuted_ = !s->Condition_ || s->Condition_();
+                s->Remaining_.store(s->NumberOfDependencies_, std::memory_order_relaxed);
+            }
+            for (auto i=0u; i<Systems_.size(); ++i)
+            {
+                if (Systems_[i]->NumberOfDependencies_ == 0)
+                    Jobs_.submit([this, i, &Counter]{this->execute(i, Counter);}, Counter);
+            }
+            Jobs_.wait(Counter);
+        }
+
+        // Called by the thread owning the stats after run()
+        void record(TickStats& _Stats) const
+        {
+            for (const auto& s : Systems_)
+            {
+                if (s->IsExecuted_ && s->Phase_ != TickPhaseType::COUNT) _Stats.record(s->Phase_, s->Elapsed_);
+            }
+        }
+
+    private:
+
+        // Dependency graph only changes when systems are added
+        void build()
+        {
+            for (auto i=0u; i<Systems_.size(); ++i)
+            {
+                Systems_[i]->Dependents_.clear();
+                Systems_[i]->NumberOfDependencies_ = 0;
+                for (auto j=0u; j<i; ++j)
+                {
+                    if (Systems_[i]->isConflicting(*Systems_[j]))
+                    {
+                        Systems_[j]->Dependents_.push_back(i);
+                        ++Systems_[i]->NumberOfDependencies_;
+                    }
+                }
+            }
+            IsBuilt_ = true;
+        }
+
+        void execute(std::size_t _i, JobCounter& _Counter)
+        {
+            auto& s = *Systems_[_i];
+
+            if (s.IsExecuted_)
+            {
+                TRACE_ZONE(s.Name_);
+                Timer t;
+                s.Run_();
+                t.stop();
+                s.Elapsed_ = t.elapsed();
+            }
+
+            // Submitted before this job is counted as done, hence, waiting
+            // on the counter includes all dependents
+            for (auto d : s.Dependents_)
+            {
+                if (Systems_[d]->Remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    Jobs_.submit([this, d, &_Counter]{this->execute(d, _Counter);}, _Counter);
+            }
+        }
+
+        JobPool& Jobs_;
+
+        std::vector<std::unique_ptr<System>> Systems_;
+        bool IsBuilt_{false};
+
+};
+
+#endif // SYSTEM_SCHEDULER_HPP
@@ -0,0 +1,104 @@
+#ifndef TICK_STATS_HPP
+#define TICK_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "latency_histogram.hpp"
+
+// Phases of a simulation tick
+enum class TickPhaseType : std::uint8_t
+{
+    QUEUE_IN,       // Command buffers and incoming requests
+    BOX2D,          // Local physics
+    GRAVITY,
+    INTEGRATION,
+    PARTICLES,      // Belts and rings
+    SUBSCRIPTIONS,  // Periodic and event based subscriptions
+    SERIALISATION,  // Dynamic data broadcast
+    TICK,           // End-to-end
+    COUNT
+};
+
+// Statistics are kept since start (or reset) and for each subscription
+// frequency, since those report since their last report
+enum class TickStatsWindowType : std::uint8_t
+{
+    S01,
+    S05,
+    S1,
+    S5,
+    S10,
+    TOTAL,
+    COUNT
+};
+
+constexpr const char* TICK_PHASE_NAMES[std::size_t(TickPhaseType::COUNT)] =
+{
+    "t_queue_in", "t_box2d", "t_gravity", "t_integration", "t_particles", "t_subscriptions", "t_serialisation", "t_tick"
+};
+
+// Keys of performance statistics, percentiles 50, 99, 99.9 and maximum of
+// each phase, so reports don't build them
+constexpr const char* TICK_PHASE_STATS_KEYS[std::size_t(TickPhaseType::COUNT)][4] =
+{
+    {"t_queue_in_p50", "t_queue_in_p99", "t_queue_in_p999", "t_queue_in_max"},
+    {"t_box2d_p50", "t_box2d_p99", "t_box2d_p999", "t_box2d_max"},
+    {"t_gravity_p50", "t_gravity_p99", "t_gravity_p999", "t_gravity_max"},
+    {"t_integration_p50", "t_integration_p99", "t_integration_p999", "t_integration_max"},
+    {"t_particles_p50", "t_particles_p99", "t_particles_p999", "t_particles_max"},
+    {"t_subscriptions_p50", "t_subscriptions_p99", "t_subscriptions_p999", "t_subscriptions_max"},
+    {"t_serialisation_p50", "t_serialisation_p99", "t_serialisation_p999", "t_serialisation_max"},
+    {"t_tick_p50", "t_tick_p99", "t_tick_p999", "t_tick_max"}
+};
+
+// Latency histograms for all tick phases. Recorded by the simulation thread,
+// may be read by any thread.
+class TickStats
+{
+
+    public:
+
+        void record(TickPhaseType _p, double _Seconds)
+        {
+            for (auto& w : Windows_) w.Phases[std::size_t(_p)].record(_Seconds);
+        }
+        void recordOverrun()
+        {
+            for (auto& w : Windows_) w.Overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const LatencyHistogram& get(TickStatsWindowType _w, TickPhaseType _p) const
+        {
+            return Windows_[std::size_t(_w)].Phases[std::size_t(_p)];
+        }
+        std::uint64_t getOverruns(TickStatsWindowType _w) const
+        {
+            return Windows_[std::size_t(_w)].Overruns.load(std::memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            for (auto i=0u; i<Windows_.size(); ++i) this->reset(TickStatsWindowType(i));
+        }
+        void reset(TickStatsWindowType _w)
+        {
+            auto& w = Windows_[std::size_t(_w)];
+            for (auto& h : w.Phases) h.reset();
+            w.Overruns.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+
+        struct Window
+        {
+            std::array<LatencyHistogram, std::size_t(TickPhaseType::COUNT)> Phases;
+            std::atomic<std::uint64_t> Overruns{0};
+        };
+
+        std::array<Window, std::size_t(TickStatsWindowType::COUNT)> Windows_;
+
+};
+
+#endif // TICK_STATS_HPP
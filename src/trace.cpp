@@ -0,0 +1,115 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    thread_local void* ThreadRing{nullptr};
+
+    // Zones close to the writing position might be overwritten while
+    // dumping, they are skipped
+    constexpr std::uint64_t DUMP_MARGIN = 256;
+}
+
+Tracer::Ring* Tracer::getRing()
+{
+    if (ThreadRing == nullptr)
+    {
+        auto r = std::make_unique<Ring>();
+        ThreadRing = r.get();
+
+        std::lock_guard<std::mutex> Lock(RingsLock_);
+        r->ThreadID = std::uint32_t(Rings_.size()) + 1;
+        r->ThreadName = "thread_" + std::to_string(r->ThreadID);
+        Rings_.push_back(std::move(r));
+    }
+    return static_cast<Ring*>(ThreadRing);
+}
+
+void Tracer::setThreadName(const std::string& _Name)
+{
+    auto* r = this->getRing();
+
+    std::lock_guard<std::mutex> Lock(RingsLock_);
+    r->ThreadName = _Name;
+}
+
+void Tracer::record(const char* _Name, std::int64_t _Begin, std::int64_t _End)
+{
+    auto* r = this->getRing();
+
+    // Single writer per ring, oldest zones are overwritten
+    const auto h = r->Head.load(std::memory_order_relaxed);
+    auto& z = r->Zones[h & (RING_SIZE-1)];
+    z.Name.store(_Name, std::memory_order_relaxed);
+    z.Begin.store(_Begin, std::memory_order_relaxed);
+    z.End.store(_End, std::memory_order_relaxed);
+    r->Head.store(h+1, std::memory_order_release);
+}
+
+std::string Tracer::createFileName()
+{
+    const auto t = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    return "pwng_trace_" + std::to_string(t) + ".json";
+}
+
+bool Tracer::dump(const std::string& _FileName)
+{
+    struct Event
+    {
+        const char* Name;
+        std::int64_t Begin;
+        std::int64_t End;
+        std::uint32_t ThreadID;
+    };
+    std::vector<Event> Events;
+    std::vector<std::pair<std::uint32_t, std::string>> Threads;
+
+    {
+        std::lock_guard<std::mutex> Lock(RingsLock_);
+        for (const auto& r : Rings_)
+        {
+            Threads.emplace_back(r->ThreadID, r->ThreadName);
+
+            const auto Head = r->Head.load(std::memory_order_acquire);
+            const auto First = Head > RING_SIZE - DUMP_MARGIN ? Head - (RING_SIZE - DUMP_MARGIN) : 0u;
+            for (auto i=First; i<Head; ++i)
+            {
+                const auto& z = r->Zones[i & (RING_SIZE-1)];
+                Event e{z.Name.load(std::memory_order_relaxed),
+                        z.Begin.load(std::memory_order_relaxed),
+                        z.End.load(std::memory_order_relaxed),
+                        r->ThreadID};
+                if (e.Name != nullptr && e.End >= e.Begin) Events.push_back(e);
+            }
+        }
+    }
+
+    std::FILE* File = std::fopen(_FileName.c_str(), "w");
+    if (File == nullptr) return false;
+
+    const auto Origin = Events.empty() ? 0 :
+                        std::min_element(Events.begin(), Events.end(),
+                                         [](const Event& _a, const Event& _b){return _a.Begin < _b.Begin;})->Begin;
+
+    std::fprintf(File, "{\"traceEvents\":[\n");
+    bool IsFirst{true};
+    for (const auto& t : Threads)
+    {
+        std::fprintf(File, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     IsFirst ? "" : ",\n", t.first, t.second.c_str());
+        IsFirst = false;
+    }
+    for (const auto& e : Events)
+    {
+        std::fprintf(File, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     IsFirst ? "" : ",\n", e.Name, e.ThreadID,
+                     double(e.Begin - Origin)*1.0e-3, double(e.End - e.Begin)*1.0e-3);
+        IsFirst = false;
+    }
+    std::fprintf(File, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return std::fclose(File) == 0;
+}
@@ -0,0 +1,117 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped trace zones, compiled in with PWNG_TRACE. Zones are only recorded
+// if tracing is enabled at runtime, otherwise they cost a relaxed atomic
+// load. Each thread records into its own ring buffer (flight recorder),
+// which keeps the most recent zones. Rings can be dumped as Chrome trace
+// event JSON, e.g. to be viewed in Perfetto.
+#ifdef PWNG_TRACE
+    #define TRACE_CONCAT_IMPL(a, b) a##b
+    #define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+    #define TRACE_ZONE(Name) TraceZone TRACE_CONCAT(TraceZone_, __LINE__){Name}
+    #define TRACE_ZONE_NAMED(Var, Name) TraceZone Var{Name}
+    #define TRACE_ZONE_END(Var) Var.end()
+    #define TRACE_THREAD(Name) Tracer::get().setThreadName(Name)
+#else
+    #define TRACE_ZONE(Name)
+    #define TRACE_ZONE_NAMED(Var, Name)
+    #define TRACE_ZONE_END(Var)
+    #define TRACE_THREAD(Name)
+#endif
+
+class Tracer
+{
+
+    public:
+
+        static Tracer& get()
+        {
+            static Tracer Instance;
+            return Instance;
+        }
+
+        static bool isEnabled() {return IsEnabled_.load(std::memory_order_relaxed);}
+        static std::int64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void setEnabled(bool _IsEnabled) {IsEnabled_.store(_IsEnabled, std::memory_order_relaxed);}
+        void setThreadName(const std::string& _Name);
+
+        void record(const char* _Name, std::int64_t _Begin, std::int64_t _End);
+
+        // Writes the content of all rings to a JSON file, returns false if
+        // file couldn't be written
+        bool dump(const std::string& _FileName);
+        static std::string createFileName();
+
+    private:
+
+        static constexpr std::size_t RING_SIZE = 16384; // Zones per thread, power of 2
+
+        struct Zone
+        {
+            std::atomic<const char*> Name{nullptr};
+            std::atomic<std::int64_t> Begin{0};
+            std::atomic<std::int64_t> End{0};
+        };
+
+        struct Ring
+        {
+            std::array<Zone, RING_SIZE> Zones;
+            std::atomic<std::uint64_t> Head{0};
+            std::uint32_t ThreadID{0};
+            std::string ThreadName;
+        };
+
+        Tracer() = default;
+
+        Ring* getRing();
+
+        static inline std::atomic_bool IsEnabled_{false};
+
+        std::mutex RingsLock_;
+        std::vector<std::unique_ptr<Ring>> Rings_;
+
+};
+
+class TraceZone
+{
+
+    public:
+
+        explicit TraceZone(const char* _Name) : Name_(_Name)
+        {
+            if (Tracer::isEnabled()) Begin_ = Tracer::now();
+        }
+        ~TraceZone() {this->end();}
+
+        // Ends zone before leaving scope
+        void end()
+        {
+            if (Begin_ != 0) Tracer::get().record(Name_, Begin_, Tracer::now());
+            Begin_ = 0;
+        }
+        TraceZone(const TraceZone&) = delete;
+        TraceZone& operator=(const TraceZone&) = delete;
+
+    private:
+
+        const char* Name_;
+        std::int64_t Begin_{0};
+
+};
+
+#endif // TRACE_HPP
@@ -0,0 +1,48 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for a single writer and a single reader. The
+// writer fills its buffer and publishes it, the reader always gets the most
+// recently published one. Neither side ever waits for the other, if the
+// reader is too slow, intermediate states are skipped.
+template<class T>
+class TripleBuffer
+{
+
+    public:
+
+        // Writer
+        T& getWriteBuffer() {return Buffers_[Write_];}
+        void publish()
+        {
+            const auto i = Middle_.exchange(std::uint8_t(Write_ | DIRTY), std::memory_order_acq_rel);
+            Write_ = i & INDEX_MASK;
+        }
+
+        // Reader, returns false if nothing new was published since last update
+        bool update()
+        {
+            if ((Middle_.load(std::memory_order_relaxed) & DIRTY) == 0) return false;
+            const auto i = Middle_.exchange(Read_, std::memory_order_acq_rel);
+            Read_ = i & INDEX_MASK;
+            return true;
+        }
+        const T& getReadBuffer() const {return Buffers_[Read_];}
+
+    private:
+
+        static constexpr std::uint8_t DIRTY = 0x4;
+        static constexpr std::uint8_t INDEX_MASK = 0x3;
+
+        std::array<T, 3> Buffers_;
+        std::uint8_t Write_{0};
+        std::uint8_t Read_{1};
+        std::atomic<std::uint8_t> Middle_{2};
+
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,53 @@
+#ifndef WORLD_STATE_HPP
+#define WORLD_STATE_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <entt/entity/entity.hpp>
+
+#include "name_component.hpp"
+#include "sim_components.hpp"
+
+// Compact, immutable copy of everything needed for the per-tick broadcast
+// of dynamic data. It is filled by the simulation thread at the end of a
+// tick and encoded by the publisher, while the next tick is running.
+// Vectors are reused, hence, there are no allocations in steady state.
+struct WorldState
+{
+    struct Body
+    {
+        entt::entity ID{entt::null};
+        char Name[NAME_SIZE_MAX]{};
+        double m{1.0};
+        double i{1.0};
+        double r{1.0};
+        double spx{0.0};
+        double spy{0.0};
+        double px{0.0};
+        double py{0.0};
+    };
+
+    struct Tire
+    {
+        entt::entity ID{entt::null};
+        float RimX{0.0f};
+        float RimY{0.0f};
+        float RimR{0.0f};
+        std::array<float, 2*TireComponent::SEGMENTS> Rubber{};
+    };
+
+    std::uint64_t Tick{0};
+    std::string   TimeStamp;        // Simulation time
+    std::uint64_t TimeStampReal{0}; // Wall clock, us
+
+    std::vector<Body> Bodies;
+    std::vector<Tire> Tires;
+
+    // Clients subscribed to dynamic data at that tick
+    std::vector<entt::entity> Clients;
+};
+
+#endif // WORLD_STATE_HPP